@@ -0,0 +1,115 @@
+/**
+ * example code for spObjectStore library
+ *
+ * two threads writing the same id of a spObjectBufferedStore, while the background thread
+ * merges every millisecond, and a third thread checking that the buffered writes are
+ * applied in the order they were made, i.e. that the value read never goes back
+ *
+ */
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+
+#include <spObjectBufferedStore.h>
+
+
+/**
+ * @brief class of objects we want to store
+ *
+ */
+class myObject
+{
+  public:
+    std::string _text = "";
+    uint32_t _number = 0;
+    myObject();
+    myObject(std::string text, uint32_t number);
+};
+
+/**
+ * constructors
+ */
+myObject::myObject()
+{
+}
+
+myObject::myObject(std::string text, uint32_t number)
+{
+  _text = text;
+  _number = number;
+}
+
+
+const uint32_t numWrites = 200000;
+
+
+int main(int argc, char *argv[])
+{
+    std::string exe_name = std::filesystem::path(argv[0]).filename().string();
+    printf("Start %s\n", exe_name.c_str());
+
+    // a merge every millisecond, many slots make it likely that the writers use different ones
+    spObjectBufferedStore<myObject> bufferedStore(ASC, 64, 1);
+
+    // the writers take turns, so the numbers are written in ascending order
+    std::mutex writeMutex;
+    uint32_t nextNumber = 1;
+    std::atomic<bool> writing(true);
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < 2; t++)
+    {
+      writers.emplace_back([&]() {
+        while (true)
+        {
+          std::lock_guard<std::mutex> lock(writeMutex);
+          if (nextNumber > numWrites)
+          {
+            return;
+          }
+          bufferedStore.setObjWithId("id", myObject("object", nextNumber));
+          nextNumber++;
+        }
+      });
+    }
+
+    // the number read must never be lower than one read before
+    size_t numReads = 0;
+    size_t numBackwards = 0;
+    std::thread reader([&]() {
+      uint32_t lastNumber = 0;
+      while (writing)
+      {
+        myObject obj;
+        if (bufferedStore.getObjById("id", obj))
+        {
+          numReads++;
+          if (obj._number < lastNumber)
+          {
+            numBackwards++;
+          }
+          lastNumber = obj._number;
+        }
+      }
+    });
+
+    for (size_t t = 0; t < writers.size(); t++)
+    {
+      writers[t].join();
+    }
+    writing = false;
+    reader.join();
+
+    bufferedStore.flush();
+    myObject obj;
+    bufferedStore.getObjById("id", obj);
+    printf("reads: %zu, reads going back: %zu\n", numReads, numBackwards);
+    printf("number stored: %u, expected: %u\n", obj._number, numWrites);
+
+    bool success = (numBackwards == 0) && (obj._number == numWrites);
+    printf("%s\n", success ? "ok" : "FAILED");
+    return success ? 0 : 1;
+}
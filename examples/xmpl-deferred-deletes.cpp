@@ -0,0 +1,123 @@
+/**
+ * example code for spObjectStore library
+ *
+ * deleting entries with deferred deletes and checking that topK() skips the deleted entries
+ * without invalidating pointers, and that the set algebra counts only include the entries
+ * not deleted
+ *
+ */
+#include <stdio.h>
+#include <string>
+#include <filesystem>
+
+#include <spObjectStore.h>
+
+
+/**
+ * @brief class of objects we want to store
+ *
+ */
+class myObject
+{
+  public:
+    std::string _text = "";
+    uint32_t _number = 0;
+    myObject();
+    myObject(std::string text, uint32_t number);
+};
+
+/**
+ * constructors
+ */
+myObject::myObject()
+{
+}
+
+myObject::myObject(std::string text, uint32_t number)
+{
+  _text = text;
+  _number = number;
+}
+
+
+/**
+ * @brief print a count, and check it
+ *
+ * @return true / false
+ */
+bool checkCount(const char *name, size_t count, size_t expected)
+{
+  printf("%s: %zu (expected %zu)\n", name, count, expected);
+  return count == expected;
+}
+
+/**
+ * @brief compare function for the objects' numbers
+ *
+ * @param obj1 a myObject object
+ * @param obj2 a myObject object
+ * @return int -1, 0 or 1
+ */
+int compareNumbers(const myObject &obj1, const myObject &obj2)
+{
+  return (obj1._number < obj2._number) ? -1 : ((obj1._number > obj2._number) ? 1 : 0);
+}
+
+/**
+ * @brief our main function
+ *
+ */
+int main(int argc, char *argv[])
+{
+    std::string exe_name = std::filesystem::path(argv[0]).filename().string();
+    printf("Start %s\n", exe_name.c_str());
+
+    bool success = true;
+    for (sposSort sorting : {None, ASC, DESC})
+    {
+      // 10 entries, of which 2 are deleted, but only marked as such
+      spObjectStore<myObject> store(sorting);
+      store.setDeferredDeletes(0.5);
+      for (uint32_t i = 0; i < 10; i++)
+      {
+        store.addObjWithId("id" + std::to_string(i), "object", i);
+      }
+      myObject *kept = store.getObjById("id8");
+      store.deleteObjById("id9");
+      store.deleteObjById("id3");
+      success &= checkCount("deleted, not removed yet", store.getDeletedCount(), 2);
+
+      // the highest numbers not deleted, without removing the deleted entries
+      uint32_t highest = 0;
+      store.topK(1, &compareNumbers, [&highest](const std::string & /* id */, const myObject &obj) {
+        highest = obj._number;
+        return true;
+      });
+      success &= checkCount("highest number", highest, 8);
+      success &= checkCount("deleted after topK()", store.getDeletedCount(), 2);
+      success &= checkCount("pointer still valid", (kept == store.getObjById("id8")) ? 1 : 0, 1);
+
+      // a store with other ids
+      spObjectStore<myObject> disjoint(sorting);
+      for (uint32_t i = 0; i < 10; i++)
+      {
+        disjoint.addObjWithId("other" + std::to_string(i), "object", i);
+      }
+      success &= checkCount("union with disjoint store", store.countUnionWith(disjoint), 18);
+      success &= checkCount("difference from disjoint store", store.countDifferenceFrom(disjoint), 8);
+
+      // the counts compact the store, so delete again for a store with some of the ids
+      store.deleteObjById("id5");
+      spObjectStore<myObject> overlapping(sorting);
+      for (uint32_t i = 4; i < 6; i++)
+      {
+        overlapping.addObjWithId("id" + std::to_string(i), "object", i);
+      }
+      success &= checkCount("union with overlapping store", store.countUnionWith(overlapping), 8);
+      success &= checkCount("intersection with overlapping store", store.countIntersectWith(overlapping), 1);
+      success &= checkCount("difference from overlapping store", store.countDifferenceFrom(overlapping), 6);
+    }
+
+    printf("%s\n", success ? "ok" : "FAILED");
+    return success ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**
+ * example code for spObjectStore library
+ *
+ * throughput of a spObjectSkipListStore and a spObjectHashStore compared to a spObjectStore
+ * guarded by a mutex, with 1 to 64 threads reading, adding and deleting objects at the same time
+ *
+ * usage: xmpl-skiplist-bench [read percentage (default 90)] [total operations (default 2000000)]
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+
+#include <spObjectStore.h>
+#include <spObjectSkipListStore.h>
+#include <spObjectHashStore.h>
+
+
+/**
+ * @brief class of objects we want to store
+ *
+ */
+class myObject
+{
+  public:
+    std::string _text = "";
+    uint32_t _number = 0;
+    myObject();
+    myObject(std::string text, uint32_t number);
+};
+
+/**
+ * constructors
+ */
+myObject::myObject()
+{
+}
+
+myObject::myObject(std::string text, uint32_t number)
+{
+  _text = text;
+  _number = number;
+}
+
+
+const size_t numKeys = 200000;
+std::vector<std::string> keys;
+
+
+/**
+ * @brief run the operations split among the threads and return the million operations per second
+ *
+ * @param numThreads  number of threads
+ * @param totalOps  number of operations of all threads
+ * @param readPercent  percentage of reads, the rest is split between adds and deletes
+ * @param operation  function of type void func(uint32_t op, const std::string &id)
+ * @return double
+ */
+double runThreads(size_t numThreads, size_t totalOps, uint32_t readPercent, std::function<void(uint32_t, const std::string&)> operation)
+{
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    threads.emplace_back([t, numThreads, totalOps, readPercent, &operation]() {
+      uint64_t state = 88172645463325252ULL + t;
+      for (size_t i = t; i < totalOps; i += numThreads)
+      {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint32_t op = state % 100;
+        op = (op < readPercent) ? 0 : ((op % 2) + 1);
+        operation(op, keys[(state >> 8) % numKeys]);
+      }
+    });
+  }
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    threads[t].join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return totalOps / seconds / 1e6;
+}
+
+/**
+ * @brief our main function
+ *
+ */
+int main(int argc, char *argv[])
+{
+    std::string a = argv[0];
+    printf("running %s\n", a.substr(a.rfind(std::filesystem::path::preferred_separator) + 1).c_str());
+
+    uint32_t readPercent = (argc > 1) ? atoi(argv[1]) : 90;
+    size_t totalOps = (argc > 2) ? atol(argv[2]) : 2000000;
+    printf("%u%% reads, %zu operations, %u hardware threads\n", readPercent, totalOps, std::thread::hardware_concurrency());
+
+    spObjectStore<myObject> idMaker;
+    for (size_t i = 0; i < numKeys; i++)
+    {
+      keys.push_back(idMaker.makeIdFromArgs((int)i));
+    }
+
+    printf("threads   mutex + spObjectStore   spObjectSkipListStore   spObjectHashStore   (million ops / s)\n");
+    for (size_t numThreads = 1; numThreads <= 64; numThreads *= 2)
+    {
+      // half of the keys stored before
+      spObjectStore<myObject> vectorStore(ASC);
+      std::mutex vectorMutex;
+      spObjectSkipListStore<myObject> skipListStore(ASC);
+      spObjectHashStore<myObject> hashStore;
+      for (size_t i = 0; i < numKeys; i += 2)
+      {
+        vectorStore.addObjWithId(keys[i], "object", i);
+        skipListStore.addObjWithId(keys[i], "object", i);
+        hashStore.addObjWithId(keys[i], "object", i);
+      }
+
+      double vectorOps = runThreads(numThreads, totalOps, readPercent, [&](uint32_t op, const std::string &id) {
+        std::lock_guard<std::mutex> lock(vectorMutex);
+        if (op == 0)
+        {
+          myObject *pObj = vectorStore.getObjById(id);
+          if (pObj != nullptr)
+          {
+            myObject obj = *pObj;
+          }
+        }
+        else if (op == 1)
+        {
+          vectorStore.addObjWithId(id, "object", 1);
+        }
+        else
+        {
+          vectorStore.deleteObjById(id);
+        }
+      });
+
+      double skipListOps = runThreads(numThreads, totalOps, readPercent, [&](uint32_t op, const std::string &id) {
+        if (op == 0)
+        {
+          myObject obj;
+          skipListStore.getObjById(id, obj);
+        }
+        else if (op == 1)
+        {
+          skipListStore.addObjWithId(id, "object", 1);
+        }
+        else
+        {
+          skipListStore.deleteObjById(id);
+        }
+      });
+
+      double hashOps = runThreads(numThreads, totalOps, readPercent, [&](uint32_t op, const std::string &id) {
+        if (op == 0)
+        {
+          myObject obj;
+          hashStore.getObjById(id, obj);
+        }
+        else if (op == 1)
+        {
+          hashStore.addObjWithId(id, "object", 1);
+        }
+        else
+        {
+          hashStore.deleteObjById(id);
+        }
+      });
+
+      printf("%7zu   %21.2f   %21.2f   %17.2f\n", numThreads, vectorOps, skipListOps, hashOps);
+    }
+
+    printf("done\n");
+}
@@ -0,0 +1,120 @@
+/**
+ * example code for spObjectStore library
+ *
+ * moving entries between stores with spliceFrom(), into an empty store and into a store
+ * with entries, and checking the number of entries moved, as well as splitting a store
+ * with an index in a batch and checking the index of the new store
+ *
+ */
+#include <stdio.h>
+#include <string>
+#include <filesystem>
+
+#include <spObjectStore.h>
+
+
+/**
+ * @brief class of objects we want to store
+ *
+ */
+class myObject
+{
+  public:
+    std::string _text = "";
+    uint32_t _number = 0;
+    myObject();
+    myObject(std::string text, uint32_t number);
+};
+
+/**
+ * constructors
+ */
+myObject::myObject()
+{
+}
+
+myObject::myObject(std::string text, uint32_t number)
+{
+  _text = text;
+  _number = number;
+}
+
+
+/**
+ * @brief callback function selecting the objects with even numbers
+ *
+ * @param id
+ * @param obj a myObject object
+ * @return true / false
+ */
+bool isEven(const std::string &id, const myObject &obj)
+{
+  return (obj._number % 2) == 0;
+}
+
+/**
+ * @brief print the number of entries moved and the sizes of both stores, and check them
+ *
+ * @return true / false
+ */
+bool checkSplice(const char *name, size_t moved, size_t expectedMoved, spObjectStore<myObject> &from, size_t expectedFrom, spObjectStore<myObject> &to, size_t expectedTo)
+{
+  printf("%s: moved %zu (expected %zu), from %zu (expected %zu), to %zu (expected %zu)\n", name,
+         moved, expectedMoved, (size_t)from.getSize(), expectedFrom, (size_t)to.getSize(), expectedTo);
+  return (moved == expectedMoved) && (from.getSize() == expectedFrom) && (to.getSize() == expectedTo);
+}
+
+/**
+ * @brief our main function
+ *
+ */
+int main(int argc, char *argv[])
+{
+    std::string exe_name = std::filesystem::path(argv[0]).filename().string();
+    printf("Start %s\n", exe_name.c_str());
+
+    bool success = true;
+    for (sposSort sorting : {None, ASC, DESC})
+    {
+      spObjectStore<myObject> source(sorting);
+      for (uint32_t i = 0; i < 10; i++)
+      {
+        source.addObjWithId("id" + std::to_string(i), "object", i);
+      }
+
+      // into an empty store
+      spObjectStore<myObject> empty(sorting);
+      size_t moved = empty.spliceFrom(source, &isEven);
+      success &= checkSplice("into empty store", moved, 5, source, 5, empty, 5);
+
+      // into a store with entries
+      spObjectStore<myObject> filled(sorting);
+      filled.addObjWithId("id10", "object", 11);
+      filled.addObjWithId("id11", "object", 13);
+      moved = filled.spliceFrom(empty, &isEven);
+      success &= checkSplice("into filled store", moved, 5, empty, 0, filled, 7);
+
+      // split in a batch, the new store's index must only have the entries moved
+      spObjectStore<myObject> indexed(sorting);
+      indexed.addIndex("number", &myObject::_number);
+      for (uint32_t i = 0; i < 10; i++)
+      {
+        indexed.addObjWithId("id" + std::to_string(i), "object", i);
+      }
+      indexed.beginBatch();
+      spObjectStore<myObject> upper = indexed.splitAt("id5");
+      indexed.commit();
+      size_t expectedLower = 0;
+      upper.forEach([&expectedLower](const std::string & /* id */, const myObject &obj) {
+        expectedLower += (obj._number < 5) ? 1 : 0;
+        return true;
+      });
+      size_t all = upper.where(&myObject::_number, GreaterEqual, 0u).count();
+      size_t lower = upper.where(&myObject::_number, Less, 5u).count();
+      printf("split in batch: indexed %zu (expected %zu), below 5 %zu (expected %zu)\n", all, (size_t)upper.getSize(), lower, expectedLower);
+      success &= (all == upper.getSize()) && (lower == expectedLower) && (upper.getSize() + indexed.getSize() == 10);
+    }
+
+    printf("%s\n", success ? "ok" : "FAILED");
+    return success ? 0 : 1;
+}
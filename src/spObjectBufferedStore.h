@@ -0,0 +1,440 @@
+/**
+ * @file spObjectBufferedStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated write-combining front end of a store, which buffers the writes of each
+ *        thread and merges them into the store in the background
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTBUFFEREDSTORE_H_
+#define SPOBJECTBUFFEREDSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <memory>
+
+#include <spObjectStore.h>
+
+
+/**
+ *  Notes:
+ *  - writes are appended as changes to a buffer chosen by the writing thread's id, i.e.
+ *    each thread has its own buffer (unless there are more threads than buffers), whose
+ *    lock is only shared with the merger, and writers never wait for the store
+ *  - changes are numbered by a global sequence number, so that changes of different
+ *    threads are applied in the order they were made
+ *  - a background thread regularly takes all buffers, sorts their changes by sequence
+ *    number and applies them with spObjectStore::applyChanges(), which merges large
+ *    batches into the store in one pass
+ *  - reads take the latest buffered change of an id, if any, and otherwise the store. As
+ *    the store is not safe for concurrent reads, reads are serialized with the merge
+ *
+*/
+
+
+/**
+ * @brief the buffered store class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectBufferedStore
+{
+   public:
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    struct alignas(64) spos_buffer_slot
+    {
+      std::mutex mutex;
+      std::vector<sposChange<T>> changes;
+      std::unordered_map<std::string, size_t> lastChange;   // id -> position in changes
+    };
+
+    spObjectStore<T> _store;
+    std::mutex _storeMutex;
+    std::unique_ptr<spos_buffer_slot[]> _slots;
+    size_t _numSlots;
+    size_t _mergeThreshold;
+    std::chrono::milliseconds _mergeInterval;
+    alignas(64) std::atomic<uint64_t> _seq;
+    std::mutex _mergerMutex;
+    std::condition_variable _mergerCV;
+    bool _mergeRequested = false;
+    bool _stop = false;
+    std::thread _merger;
+
+    void bufferChange(sposChangeOp op, const std::string &id, std::shared_ptr<const T> obj);
+    void mergeBuffers();
+    void runMerger();
+
+   public:
+    spObjectBufferedStore(sposSort sorting = ASC, size_t numSlots = 64, uint32_t mergeIntervalMs = 10, size_t mergeThreshold = 4096);
+    spObjectBufferedStore(const spObjectBufferedStore<T> &other) = delete;
+    spObjectBufferedStore<T>& operator=(const spObjectBufferedStore<T> &other) = delete;
+    ~spObjectBufferedStore();
+    template <class... Vs>
+    void addObjWithId(const std::string &id, Vs... args);
+    void setObjWithId(const std::string &id, const T &newObj);
+    void deleteObjById(const std::string &id);
+    void reset();
+    bool getObjById(const std::string &id, T &obj);
+    void flush();
+    size_t getPendingCount();
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ *
+ * @param sorting  sorting of the store
+ * @param numSlots  number of write buffers, i.e. threads writing without sharing a buffer
+ * @param mergeIntervalMs  milliseconds between merges
+ * @param mergeThreshold  number of changes in a buffer, which triggers a merge before the
+ *                        interval has passed
+ */
+template <class T>
+spObjectBufferedStore<T>::spObjectBufferedStore(sposSort sorting, size_t numSlots, uint32_t mergeIntervalMs, size_t mergeThreshold)
+  : _store(sorting), _slots(new spos_buffer_slot[numSlots > 0 ? numSlots : 1]), _numSlots(numSlots > 0 ? numSlots : 1),
+    _mergeThreshold(mergeThreshold), _mergeInterval(mergeIntervalMs), _seq(0)
+{
+  _merger = std::thread(&spObjectBufferedStore<T>::runMerger, this);
+}
+
+/**
+ * destructor, which stops the merger
+ */
+template <class T>
+spObjectBufferedStore<T>::~spObjectBufferedStore()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mergerMutex);
+    _stop = true;
+  }
+  _mergerCV.notify_one();
+  _merger.join();
+}
+
+/**
+ * @brief Create an object and buffer it to be stored with the given id, replacing an
+ *        existing object with this id
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ */
+template<class T> template<class... Vs>
+void spObjectBufferedStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  bufferChange(ChangeInsert, id, std::make_shared<const T>(args...));
+}
+
+/**
+ * @brief Buffer a copy(!) of an object to be stored with the given id, replacing an
+ *        existing object with this id
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is copied
+ */
+template <class T>
+void spObjectBufferedStore<T>::setObjWithId(const std::string &id, const T &newObj)
+{
+  bufferChange(ChangeReplace, id, std::make_shared<const T>(newObj));
+}
+
+/**
+ * @brief Buffer the deletion of the object with the given id
+ *
+ * @param id  id of the object to delete
+ */
+template <class T>
+void spObjectBufferedStore<T>::deleteObjById(const std::string &id)
+{
+  bufferChange(ChangeErase, id, nullptr);
+}
+
+/**
+ * @brief Delete all objects and all buffered changes
+ *
+ */
+template <class T>
+void spObjectBufferedStore<T>::reset()
+{
+  std::lock_guard<std::mutex> storeLock(_storeMutex);
+  for (size_t i = 0; i < _numSlots; i++)
+  {
+    std::lock_guard<std::mutex> lock(_slots[i].mutex);
+    _slots[i].changes.clear();
+    _slots[i].lastChange.clear();
+  }
+  _store.reset();
+}
+
+/**
+ * @brief Copy the object with the given id into obj and return success. Buffered changes
+ *        not merged yet are taken into account
+ *
+ * @param id  id of the object to find
+ * @param obj  object to copy the stored object to
+ * @return true / false
+ */
+template <class T>
+bool spObjectBufferedStore<T>::getObjById(const std::string &id, T &obj)
+{
+  std::lock_guard<std::mutex> storeLock(_storeMutex);
+  // latest buffered change of the id
+  uint64_t latestSeq = 0;
+  bool buffered = false;
+  std::shared_ptr<const T> latestObj;
+  for (size_t i = 0; i < _numSlots; i++)
+  {
+    std::lock_guard<std::mutex> lock(_slots[i].mutex);
+    auto it = _slots[i].lastChange.find(id);
+    if (it != _slots[i].lastChange.end())
+    {
+      const sposChange<T> &change = _slots[i].changes[it->second];
+      if (!buffered || (change.seq > latestSeq))
+      {
+        buffered = true;
+        latestSeq = change.seq;
+        latestObj = change.obj;
+      }
+    }
+  }
+  if (buffered)
+  {
+    if (latestObj == nullptr)
+    {
+      return false;
+    }
+    obj = *latestObj;
+    return true;
+  }
+
+  T *pObj = _store.getObjById(id);
+  if (pObj == nullptr)
+  {
+    return false;
+  }
+  obj = *pObj;
+  return true;
+}
+
+/**
+ * @brief Merge all buffered changes into the store now
+ *
+ */
+template <class T>
+void spObjectBufferedStore<T>::flush()
+{
+  mergeBuffers();
+}
+
+/**
+ * @brief Returns the number of buffered changes not merged yet
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectBufferedStore<T>::getPendingCount()
+{
+  size_t count = 0;
+  for (size_t i = 0; i < _numSlots; i++)
+  {
+    std::lock_guard<std::mutex> lock(_slots[i].mutex);
+    count += _slots[i].changes.size();
+  }
+  return count;
+}
+
+/**
+ * @brief Loop through all objects and call function callback(obj), until the callback
+ *        returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T>
+void spObjectBufferedStore<T>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Merge the buffered changes and loop through all objects in the store's order,
+ *        calling function callback(id, obj), until the callback returns false. The
+ *        callback must not read or write this store
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectBufferedStore<T>::forEach(spos_forEach_IO_callback callback)
+{
+  mergeBuffers();
+  std::lock_guard<std::mutex> storeLock(_storeMutex);
+  _store.forEach(callback);
+}
+
+/**
+ * @brief Merge the buffered changes and return the number of objects stored
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectBufferedStore<T>::getSize()
+{
+  mergeBuffers();
+  std::lock_guard<std::mutex> storeLock(_storeMutex);
+  return _store.getSize();
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * @brief Append a change to the buffer of the calling thread and request a merge, when
+ *        the buffer reached the threshold
+ *
+ * @param op  the change
+ * @param id  id of the object
+ * @param obj  the object or nullptr
+ */
+template <class T>
+void spObjectBufferedStore<T>::bufferChange(sposChangeOp op, const std::string &id, std::shared_ptr<const T> obj)
+{
+  spos_buffer_slot &slot = _slots[std::hash<std::thread::id>()(std::this_thread::get_id()) % _numSlots];
+  bool full;
+  {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    sposChange<T> change;
+    change.op = op;
+    change.id = id;
+    change.obj = std::move(obj);
+    change.seq = _seq.fetch_add(1, std::memory_order_relaxed) + 1;
+    slot.lastChange[id] = slot.changes.size();
+    slot.changes.push_back(std::move(change));
+    full = (slot.changes.size() == _mergeThreshold);
+  }
+  if (full)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mergerMutex);
+      _mergeRequested = true;
+    }
+    _mergerCV.notify_one();
+  }
+}
+
+/**
+ * @brief Take the changes of all buffers and apply them in the order of their sequence
+ *        numbers to the store. All buffers are locked while taking them, as a change 
+ *        made to a buffer already taken could otherwise get an older sequence number 
+ *        than a change of the same id taken from a later buffer
+ *
+ */
+template <class T>
+void spObjectBufferedStore<T>::mergeBuffers()
+{
+  std::lock_guard<std::mutex> storeLock(_storeMutex);
+  std::vector<std::vector<sposChange<T>>> slotChanges(_numSlots);
+  {
+    // always locked in the order of the slots, writers only lock one slot
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(_numSlots);
+    for (size_t i = 0; i < _numSlots; i++)
+    {
+      locks.emplace_back(_slots[i].mutex);
+    }
+    for (size_t i = 0; i < _numSlots; i++)
+    {
+      slotChanges[i].swap(_slots[i].changes);
+      _slots[i].lastChange.clear();
+    }
+  }
+  std::vector<sposChange<T>> changes;
+  for (size_t i = 0; i < _numSlots; i++)
+  {
+    if (changes.empty())
+    {
+      changes.swap(slotChanges[i]);
+    }
+    else
+    {
+      changes.insert(changes.end(), std::make_move_iterator(slotChanges[i].begin()), std::make_move_iterator(slotChanges[i].end()));
+    }
+  }
+  if (changes.empty())
+  {
+    return;
+  }
+  std::sort(changes.begin(), changes.end(), [](const sposChange<T> &a, const sposChange<T> &b) { return a.seq < b.seq; });
+  _store.applyChanges(changes);
+}
+
+/**
+ * @brief Background thread merging the buffers after each interval or when requested,
+ *        and a last time when stopped
+ *
+ */
+template <class T>
+void spObjectBufferedStore<T>::runMerger()
+{
+  std::unique_lock<std::mutex> lock(_mergerMutex);
+  while (!_stop)
+  {
+    _mergerCV.wait_for(lock, _mergeInterval, [this]() { return _stop || _mergeRequested; });
+    _mergeRequested = false;
+    lock.unlock();
+    mergeBuffers();
+    lock.lock();
+  }
+}
+
+
+#endif
@@ -0,0 +1,510 @@
+/**
+ * @file spObjectGapStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated store class sorted by ids, which keeps a gap of empty slots at the
+ *        position of the last change, so that inserts clustered in one region of ids only
+ *        move a few entries
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTGAPSTORE_H_
+#define SPOBJECTGAPSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+#include <spObjectStore.h>
+
+
+/**
+ *  Notes:
+ *  - entries are kept sorted by ids in slots [0, gapStart) and [gapEnd, capacity), i.e. a
+ *    position p is stored in slot p before the gap and in slot p + gap size after it
+ *  - an insert or delete first moves the gap to its position, which moves only the entries
+ *    between the old and new position of the gap, and then uses or widens the gap
+ *  - when the gap is used up, the slots are reallocated with a gap of half the entries at
+ *    the same position, and when the gap is more than 3/4 of the slots after deletes, they
+ *    are reallocated with a gap of a quarter, i.e. the density stays between 1/4 and 1
+ *  - empty slots hold no objects, i.e. T needs no default constructor
+ *  - pointers to objects are valid until the next change of the store
+ *
+*/
+
+
+/**
+ * @brief the gap store class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectGapStore
+{
+   public:
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    std::vector<std::string> _ids;
+    std::vector<spos_optional<T>> _objects;
+    size_t _gapStart = 0;
+    size_t _gapEnd = 0;
+    sposSort _sorting;
+    bool _added = false;
+
+    size_t slotOf(size_t pos);
+    int32_t compareIds(const std::string &id1, const std::string &id2);
+    size_t lowerBound(const std::string &id);
+    void moveGap(size_t pos);
+    void resizeSlots(size_t capacity);
+    template <class... Vs>
+    T* insertAt(size_t pos, const std::string &id, Vs&&... args);
+
+   public:
+    spObjectGapStore(sposSort sorting = ASC);
+    template <class... Vs>
+    T* addObjWithId(const std::string &id, Vs... args);
+    T* setObjWithId(const std::string &id, const T &newObj);
+    T* setObjWithId(const std::string &id, T &&newObj);
+    T* getObjById(const std::string &id);
+    bool deleteObjById(const std::string &id);
+    void reset();
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    T* getObjAt(size_t pos);
+    std::string getIdAt(size_t pos);
+    size_t getSize();
+    size_t getCapacity();
+    bool isAdded();
+    sposSort getSorting();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ *
+ * @param sorting  ASC or DESC (None is handled as ASC)
+ */
+template <class T>
+spObjectGapStore<T>::spObjectGapStore(sposSort sorting)
+{
+  _sorting = (sorting == DESC) ? DESC : ASC;
+}
+
+/**
+ * @brief Create an object, add it with the given id and return a pointer to it. If an
+ *        object with this id already exists, then it is replaced by the new object
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return T* pointer to object stored
+ */
+template<class T> template<class... Vs>
+T* spObjectGapStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  return insertAt(lowerBound(id), id, std::move(args)...);
+}
+
+/**
+ * @brief Set a copy(!) of an object with the given id, which is either replacing an
+ *        existing one or adding a new id - object pair
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is copied
+ * @return T* pointer to object stored
+ */
+template <class T>
+T* spObjectGapStore<T>::setObjWithId(const std::string &id, const T &newObj)
+{
+  return insertAt(lowerBound(id), id, newObj);
+}
+
+/**
+ * @brief Set an object with the given id by moving it into the store, which is either
+ *        replacing an existing one or adding a new id - object pair
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is moved
+ * @return T* pointer to object stored
+ */
+template <class T>
+T* spObjectGapStore<T>::setObjWithId(const std::string &id, T &&newObj)
+{
+  return insertAt(lowerBound(id), id, std::move(newObj));
+}
+
+/**
+ * @brief Get an object with the given id and return a pointer to it.
+ *        If no object with this id exists, a nullptr is returned
+ *
+ * @param id  id of the object to find
+ * @return T* pointer to object stored
+ */
+template <class T>
+T* spObjectGapStore<T>::getObjById(const std::string &id)
+{
+  size_t pos = lowerBound(id);
+  if ((pos < getSize()) && (_ids[slotOf(pos)] == id))
+  {
+    return &*_objects[slotOf(pos)];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template <class T>
+bool spObjectGapStore<T>::deleteObjById(const std::string &id)
+{
+  size_t pos = lowerBound(id);
+  if ((pos >= getSize()) || (_ids[slotOf(pos)] != id))
+  {
+    return false;
+  }
+  // gap right after the entry, which then becomes part of it
+  moveGap(pos + 1);
+  _gapStart--;
+  _ids[_gapStart].clear();
+  _objects[_gapStart].reset();
+  if ((_objects.size() > 64) && (getSize() < _objects.size() / 4))
+  {
+    resizeSlots(getSize() + getSize() / 4 + 16);
+  }
+  return true;
+}
+
+/**
+ * @brief Delete all objects
+ *
+ */
+template <class T>
+void spObjectGapStore<T>::reset()
+{
+  _ids.clear();
+  _objects.clear();
+  _gapStart = 0;
+  _gapEnd = 0;
+}
+
+/**
+ * @brief Loop through all objects in the order of their ids and call function
+ *        callback(obj), until the callback returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T>
+void spObjectGapStore<T>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Loop through all objects in the order of their ids and call function
+ *        callback(id, obj), until the callback returns false. The gap is skipped at once
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectGapStore<T>::forEach(spos_forEach_IO_callback callback)
+{
+  for (size_t i = 0; i < _gapStart; i++)
+  {
+    if (!callback(_ids[i], *_objects[i]))
+    {
+      return;
+    }
+  }
+  for (size_t i = _gapEnd; i < _objects.size(); i++)
+  {
+    if (!callback(_ids[i], *_objects[i]))
+    {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Returns a pointer to the object at the given position (0 .. getSize() - 1) or
+ *        a nullptr if the position is out of range
+ *
+ * @param pos  position in the store
+ * @return T* pointer to object stored
+ */
+template <class T>
+T* spObjectGapStore<T>::getObjAt(size_t pos)
+{
+  if (pos >= getSize())
+  {
+    return nullptr;
+  }
+  return &*_objects[slotOf(pos)];
+}
+
+/**
+ * @brief Returns the id of the object at the given position (0 .. getSize() - 1) or
+ *        an empty string if the position is out of range
+ *
+ * @param pos  position in the store
+ * @return std::string  the id of the object stored
+ */
+template <class T>
+std::string spObjectGapStore<T>::getIdAt(size_t pos)
+{
+  if (pos >= getSize())
+  {
+    return "";
+  }
+  return _ids[slotOf(pos)];
+}
+
+/**
+ * @brief Returns the number of objects stored
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectGapStore<T>::getSize()
+{
+  return _objects.size() - (_gapEnd - _gapStart);
+}
+
+/**
+ * @brief Returns the number of slots, i.e. objects stored plus the size of the gap
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectGapStore<T>::getCapacity()
+{
+  return _objects.size();
+}
+
+/**
+ * @brief Returns true if the last addObjWithId() or setObjWithId() added a new id, false
+ *        if it replaced an object
+ *
+ * @return true / false
+ */
+template <class T>
+bool spObjectGapStore<T>::isAdded()
+{
+  return _added;
+}
+
+/**
+ * @brief Returns the sorting
+ *
+ * @return sposSort
+ */
+template <class T>
+sposSort spObjectGapStore<T>::getSorting()
+{
+  return _sorting;
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * @brief Returns the slot of the entry at pos
+ *
+ * @param pos  position of the entry
+ * @return size_t
+ */
+template <class T>
+size_t spObjectGapStore<T>::slotOf(size_t pos)
+{
+  return (pos < _gapStart) ? pos : pos + (_gapEnd - _gapStart);
+}
+
+/**
+ * @brief Compare ids based on sorting
+ *
+ * @param id1
+ * @param id2
+ * @return int32_t  <0 if id1 is before id2, 0 if equal, >0 if after
+ */
+template <class T>
+int32_t spObjectGapStore<T>::compareIds(const std::string &id1, const std::string &id2)
+{
+  int32_t cmpRes = strcmp(id1.c_str(), id2.c_str());
+  if (_sorting == DESC)
+  {
+    cmpRes *= -1;
+  }
+  return cmpRes;
+}
+
+/**
+ * @brief Returns the position of the first entry not before id, checking the position at
+ *        the gap first, as changes tend to be close to the last one
+ *
+ * @param id  the id
+ * @return size_t
+ */
+template <class T>
+size_t spObjectGapStore<T>::lowerBound(const std::string &id)
+{
+  size_t first = 0;
+  size_t count = getSize();
+  // entries before and after the gap
+  bool afterPrev = (_gapStart == 0) || (compareIds(_ids[_gapStart - 1], id) < 0);
+  bool beforeNext = (_gapEnd == _objects.size()) || (compareIds(_ids[_gapEnd], id) >= 0);
+  if (afterPrev && beforeNext)
+  {
+    return _gapStart;
+  }
+  while (count > 0)
+  {
+    size_t step = count / 2;
+    if (compareIds(_ids[slotOf(first + step)], id) < 0)
+    {
+      first += step + 1;
+      count -= step + 1;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+/**
+ * @brief Move the gap to start at pos, moving the entries between the old and new start
+ *
+ * @param pos  position of the entry to be after the gap
+ */
+template <class T>
+void spObjectGapStore<T>::moveGap(size_t pos)
+{
+  if (_gapStart == _gapEnd)
+  {
+    _gapStart = pos;
+    _gapEnd = pos;
+    return;
+  }
+  while (_gapStart > pos)
+  {
+    // entry before the gap to its end
+    _gapStart--;
+    _gapEnd--;
+    _ids[_gapEnd] = std::move(_ids[_gapStart]);
+    _objects[_gapEnd] = std::move(_objects[_gapStart]);
+    _objects[_gapStart].reset();
+  }
+  while (_gapStart < pos)
+  {
+    // entry after the gap to its start
+    _ids[_gapStart] = std::move(_ids[_gapEnd]);
+    _objects[_gapStart] = std::move(_objects[_gapEnd]);
+    _objects[_gapEnd].reset();
+    _gapStart++;
+    _gapEnd++;
+  }
+}
+
+/**
+ * @brief Reallocate the slots with the gap at the same position
+ *
+ * @param capacity  new number of slots, at least the number of entries
+ */
+template <class T>
+void spObjectGapStore<T>::resizeSlots(size_t capacity)
+{
+  size_t size = getSize();
+  size_t gapEnd = capacity - (_objects.size() - _gapEnd);
+  std::vector<std::string> ids(capacity);
+  std::vector<spos_optional<T>> objects(capacity);
+  for (size_t i = 0; i < _gapStart; i++)
+  {
+    ids[i] = std::move(_ids[i]);
+    objects[i] = std::move(_objects[i]);
+  }
+  for (size_t i = _gapEnd; i < _objects.size(); i++)
+  {
+    ids[i - _gapEnd + gapEnd] = std::move(_ids[i]);
+    objects[i - _gapEnd + gapEnd] = std::move(_objects[i]);
+  }
+  _ids.swap(ids);
+  _objects.swap(objects);
+  _gapEnd = _gapStart + (capacity - size);
+}
+
+/**
+ * @brief Store the object at pos, either replacing the entry with this id or inserting a
+ *        new one into the gap moved to pos
+ *
+ * @param pos  position of the first entry not before id
+ * @param id  id of the object
+ * @param args  arguments to construct T
+ * @return T* pointer to object stored
+ */
+template <class T> template <class... Vs>
+T* spObjectGapStore<T>::insertAt(size_t pos, const std::string &id, Vs&&... args)
+{
+  if ((pos < getSize()) && (_ids[slotOf(pos)] == id))
+  {
+    _added = false;
+    size_t slot = slotOf(pos);
+    // assign instead of emplace, as args may refer to the stored object itself
+    *_objects[slot] = T(std::forward<Vs>(args)...);
+    return &*_objects[slot];
+  }
+  _added = true;
+  // args may refer to a stored object, which moving the gap would move
+  T obj(std::forward<Vs>(args)...);
+  moveGap(pos);
+  if (_gapStart == _gapEnd)
+  {
+    resizeSlots(getSize() + getSize() / 2 + 16);
+  }
+  _ids[_gapStart] = id;
+  _objects[_gapStart].emplace(std::move(obj));
+  return &*_objects[_gapStart++];
+}
+
+
+#endif
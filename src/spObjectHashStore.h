@@ -0,0 +1,299 @@
+/**
+ * @file spObjectHashStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated unsorted store class based on a lock-striped hash table for concurrent
+ *        point lookups and writes from many threads
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTHASHSTORE_H_
+#define SPOBJECTHASHSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+
+
+/**
+ *  Notes:
+ *  - ids are hashed to one of STRIPES stripes (template parameter, a power of 2), each being
+ *    a hash table with its own reader / writer lock on a separate cache line
+ *  - readers of different stripes never touch the same memory and readers of the same stripe
+ *    share its lock, i.e. with many more stripes than threads lookups scale with the cores
+ *  - each stripe grows on its own, i.e. a resize only blocks the threads using that stripe
+ *  - objects are copied out, as other threads may replace or delete them at any time
+ *  - forEach() locks one stripe after the other, i.e. it sees entries changed meanwhile
+ *    either before or after the change. The order is not sorted
+ *
+*/
+
+
+/**
+ * @brief the hash store class
+ * @tparam T  class typename of objects to store
+ * @tparam STRIPES  number of stripes, a power of 2 (default 64)
+ */
+template <class T, size_t STRIPES = 64>
+class spObjectHashStore
+{
+    static_assert((STRIPES > 0) && ((STRIPES & (STRIPES - 1)) == 0), "STRIPES must be a power of 2");
+
+   public:
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    struct alignas(64) spos_hash_stripe
+    {
+      std::shared_mutex mutex;
+      std::unordered_map<std::string, T> objects;
+    };
+
+    std::unique_ptr<spos_hash_stripe[]> _stripes;
+
+    spos_hash_stripe& stripeOf(const std::string &id);
+    bool storeObj(const std::string &id, T &&obj);
+
+   public:
+    spObjectHashStore();
+    spObjectHashStore(const spObjectHashStore<T, STRIPES> &other) = delete;
+    spObjectHashStore<T, STRIPES>& operator=(const spObjectHashStore<T, STRIPES> &other) = delete;
+    template <class... Vs>
+    bool addObjWithId(const std::string &id, Vs... args);
+    bool setObjWithId(const std::string &id, const T &newObj);
+    bool getObjById(const std::string &id, T &obj);
+    bool isStored(const std::string &id);
+    bool deleteObjById(const std::string &id);
+    void reset();
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ */
+template <class T, size_t STRIPES>
+spObjectHashStore<T, STRIPES>::spObjectHashStore() : _stripes(new spos_hash_stripe[STRIPES])
+{
+}
+
+/**
+ * @brief Create an object and store it with the given id. If an object with this id
+ *        already exists, then it is replaced by the new object
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T, size_t STRIPES> template<class... Vs>
+bool spObjectHashStore<T, STRIPES>::addObjWithId(const std::string &id, Vs... args)
+{
+  return storeObj(id, T(args...));
+}
+
+/**
+ * @brief Store a copy(!) of an object with the given id, which is either replacing an
+ *        existing one or adding a new id - object pair
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is copied
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T, size_t STRIPES>
+bool spObjectHashStore<T, STRIPES>::setObjWithId(const std::string &id, const T &newObj)
+{
+  return storeObj(id, T(newObj));
+}
+
+/**
+ * @brief Copy the object with the given id into obj and return success
+ *
+ * @param id  id of the object to find
+ * @param obj  object to copy the stored object to
+ * @return true / false
+ */
+template <class T, size_t STRIPES>
+bool spObjectHashStore<T, STRIPES>::getObjById(const std::string &id, T &obj)
+{
+  spos_hash_stripe &stripe = stripeOf(id);
+  std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+  auto it = stripe.objects.find(id);
+  if (it == stripe.objects.end())
+  {
+    return false;
+  }
+  obj = it->second;
+  return true;
+}
+
+/**
+ * @brief Returns true if an object with the given id is stored
+ *
+ * @param id  id of the object to find
+ * @return true / false
+ */
+template <class T, size_t STRIPES>
+bool spObjectHashStore<T, STRIPES>::isStored(const std::string &id)
+{
+  spos_hash_stripe &stripe = stripeOf(id);
+  std::shared_lock<std::shared_mutex> lock(stripe.mutex);
+  return stripe.objects.count(id) > 0;
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template <class T, size_t STRIPES>
+bool spObjectHashStore<T, STRIPES>::deleteObjById(const std::string &id)
+{
+  spos_hash_stripe &stripe = stripeOf(id);
+  std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+  return stripe.objects.erase(id) > 0;
+}
+
+/**
+ * @brief Delete all objects, one stripe after the other
+ *
+ */
+template <class T, size_t STRIPES>
+void spObjectHashStore<T, STRIPES>::reset()
+{
+  for (size_t i = 0; i < STRIPES; i++)
+  {
+    std::unique_lock<std::shared_mutex> lock(_stripes[i].mutex);
+    _stripes[i].objects.clear();
+  }
+}
+
+/**
+ * @brief Loop through all objects and call function callback(obj), until the callback
+ *        returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T, size_t STRIPES>
+void spObjectHashStore<T, STRIPES>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Loop through all objects and call function callback(id, obj), until the
+ *        callback returns false. The callback is called while holding the stripe's
+ *        read lock and must not write to this store
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T, size_t STRIPES>
+void spObjectHashStore<T, STRIPES>::forEach(spos_forEach_IO_callback callback)
+{
+  for (size_t i = 0; i < STRIPES; i++)
+  {
+    std::shared_lock<std::shared_mutex> lock(_stripes[i].mutex);
+    for (auto &entry : _stripes[i].objects)
+    {
+      if (!callback(entry.first, entry.second))
+      {
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Returns the number of objects stored, i.e. the sum of all stripes, which may
+ *        change while counting
+ *
+ * @return size_t
+ */
+template <class T, size_t STRIPES>
+size_t spObjectHashStore<T, STRIPES>::getSize()
+{
+  size_t size = 0;
+  for (size_t i = 0; i < STRIPES; i++)
+  {
+    std::shared_lock<std::shared_mutex> lock(_stripes[i].mutex);
+    size += _stripes[i].objects.size();
+  }
+  return size;
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * @brief Returns the stripe of the id, using the upper bits of the hash, as the lower
+ *        ones select the bucket within the stripe
+ *
+ * @param id  id of an object
+ * @return spos_hash_stripe&
+ */
+template <class T, size_t STRIPES>
+typename spObjectHashStore<T, STRIPES>::spos_hash_stripe& spObjectHashStore<T, STRIPES>::stripeOf(const std::string &id)
+{
+  uint64_t hash = std::hash<std::string>()(id) * 0x9e3779b97f4a7c15ULL;
+  return _stripes[(hash >> 32) & (STRIPES - 1)];
+}
+
+/**
+ * @brief Store the object with the id under the stripe's write lock
+ *
+ * @param id  id of the object
+ * @param obj  the object, which is moved into the store
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T, size_t STRIPES>
+bool spObjectHashStore<T, STRIPES>::storeObj(const std::string &id, T &&obj)
+{
+  spos_hash_stripe &stripe = stripeOf(id);
+  std::unique_lock<std::shared_mutex> lock(stripe.mutex);
+  return stripe.objects.insert_or_assign(id, std::move(obj)).second;
+}
+
+
+#endif
@@ -0,0 +1,951 @@
+/**
+ * @file spObjectMVCCStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated store class with multi-version concurrency control, whereby readers
+ *        see a consistent snapshot of the store while writers continue
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTMVCCSTORE_H_
+#define SPOBJECTMVCCSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <utility>
+
+#include <spObjectStore.h>
+
+
+/**
+ *  Notes:
+ *  - each write creates a new version of the entry, tagged with the store's epoch, which
+ *    increases by one with each write (or reset)
+ *  - readers take a snapshot, which pins the current epoch and sees the newest version of
+ *    each entry not newer than this epoch, without taking locks or waiting for writers
+ *  - writers are serialized by a mutex
+ *  - entries are found by id in an open addressing hash table, which readers probe without
+ *    locks, i.e. forEach() loops through the entries unsorted
+ *  - versions no snapshot can see anymore are reclaimed by the writers (epoch based garbage
+ *    collection), whereby a long running snapshot only holds back the versions replaced
+ *    after its epoch
+ *
+*/
+
+
+template <class T>
+class spObjectMVCCStore;
+
+
+/**
+ * @brief a reader's view of a spObjectMVCCStore at the epoch pinned when it was taken,
+ *        which lasts until the snapshot is released or destroyed
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spObjectMVCCSnapshot
+{
+   public:
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    spObjectMVCCStore<T> *_store = nullptr;
+    size_t _slot = 0;
+    uint64_t _epoch = 0;
+
+    friend class spObjectMVCCStore<T>;
+    spObjectMVCCSnapshot(spObjectMVCCStore<T> *store, size_t slot, uint64_t epoch);
+
+   public:
+    spObjectMVCCSnapshot(const spObjectMVCCSnapshot<T> &other) = delete;
+    spObjectMVCCSnapshot<T>& operator=(const spObjectMVCCSnapshot<T> &other) = delete;
+    spObjectMVCCSnapshot(spObjectMVCCSnapshot<T> &&other);
+    spObjectMVCCSnapshot<T>& operator=(spObjectMVCCSnapshot<T> &&other);
+    ~spObjectMVCCSnapshot();
+    const T* getObjById(const std::string &id);
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+    uint64_t getEpoch();
+    void release();
+};
+
+
+/**
+ * @brief the multi-version store class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectMVCCStore
+{
+   private:
+    struct spos_mvcc_version
+    {
+      uint64_t epoch;
+      std::atomic<spos_mvcc_version*> older;
+      spos_optional<T> obj;                     // empty for deleted entries
+      spos_mvcc_version(uint64_t versionEpoch) : epoch(versionEpoch), older(nullptr) {}
+    };
+    struct spos_mvcc_entry
+    {
+      std::string id;
+      std::atomic<spos_mvcc_version*> head;
+      bool pending = false;                     // in the list of entries to collect
+      spos_mvcc_entry(const std::string &entryId) : id(entryId), head(nullptr) {}
+    };
+    struct spos_mvcc_table
+    {
+      size_t mask;
+      size_t used = 0;                          // slots with entries or removed markers
+      std::unique_ptr<std::atomic<spos_mvcc_entry*>[]> slots;
+      spos_mvcc_table(size_t capacity);
+    };
+
+    std::mutex _mutex;
+    std::atomic<uint64_t> _epoch;
+    std::atomic<spos_mvcc_table*> _table;
+    std::atomic<size_t> _size;
+    std::unique_ptr<std::atomic<uint64_t>[]> _readers;
+    size_t _maxReaders;
+    spos_mvcc_entry _removed;                   // marker for slots of removed entries
+    std::vector<spos_mvcc_entry*> _pending;
+    std::vector<std::pair<uint64_t, spos_mvcc_entry*>> _retiredEntries;
+    std::vector<std::pair<uint64_t, spos_mvcc_table*>> _retiredTables;
+    size_t _gcThreshold = 64;
+    size_t _writesSinceGC = 0;
+    size_t _versionCount = 0;
+    bool _added = false;
+
+    friend class spObjectMVCCSnapshot<T>;
+
+    spos_mvcc_entry* findEntry(spos_mvcc_table *table, const std::string &id);
+    spos_mvcc_entry* findOrCreateEntry(const std::string &id);
+    void growTable();
+    void removeEntry(spos_mvcc_entry *entry);
+    void linkVersion(spos_mvcc_entry *entry, spos_mvcc_version *version);
+    uint64_t finishWrite(uint64_t epoch);
+    uint64_t getMinPinnedEpoch();
+    size_t collectLocked();
+    size_t deleteVersions(spos_mvcc_version *version);
+    size_t deleteEntry(spos_mvcc_entry *entry);
+    size_t pinSlot();
+    const T* visibleObj(spos_mvcc_entry *entry, uint64_t epoch);
+
+   public:
+    spObjectMVCCStore(size_t maxReaders = 64);
+    spObjectMVCCStore(const spObjectMVCCStore<T> &other) = delete;
+    spObjectMVCCStore<T>& operator=(const spObjectMVCCStore<T> &other) = delete;
+    ~spObjectMVCCStore();
+    template <class... Vs>
+    uint64_t addObjWithId(const std::string &id, Vs... args);
+    uint64_t setObjWithId(const std::string &id, const T &newObj);
+    bool deleteObjById(const std::string &id);
+    void reset();
+    spObjectMVCCSnapshot<T> getSnapshot();
+    uint64_t getEpoch();
+    size_t getSize();
+    bool isAdded();
+    size_t getVersionCount();
+    size_t collect();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ *
+ * @param maxReaders  maximum number of snapshots at the same time, further readers wait
+ *                    for a snapshot to be released
+ */
+template <class T>
+spObjectMVCCStore<T>::spObjectMVCCStore(size_t maxReaders) : _epoch(0), _table(new spos_mvcc_table(16)), _size(0), _removed("")
+{
+  _maxReaders = (maxReaders > 0) ? maxReaders : 1;
+  _readers.reset(new std::atomic<uint64_t>[_maxReaders]);
+  for (size_t i = 0; i < _maxReaders; i++)
+  {
+    _readers[i].store(UINT64_MAX);
+  }
+}
+
+/**
+ * destructor - all snapshots must have been released before
+ */
+template <class T>
+spObjectMVCCStore<T>::~spObjectMVCCStore()
+{
+  spos_mvcc_table *table = _table.load();
+  for (size_t i = 0; i <= table->mask; i++)
+  {
+    spos_mvcc_entry *entry = table->slots[i].load();
+    if ((entry != nullptr) && (entry != &_removed))
+    {
+      deleteEntry(entry);
+    }
+  }
+  delete table;
+  for (size_t i = 0; i < _retiredEntries.size(); i++)
+  {
+    deleteEntry(_retiredEntries[i].second);
+  }
+  for (size_t i = 0; i < _retiredTables.size(); i++)
+  {
+    delete _retiredTables[i].second;
+  }
+}
+
+/**
+ * @brief Create an object and add it with the given id as a new version of this id's
+ *        entry, which is visible to snapshots taken afterwards
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return uint64_t  the epoch of this write
+ */
+template<class T> template<class... Vs>
+uint64_t spObjectMVCCStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  spos_mvcc_entry *entry = findOrCreateEntry(id);
+  spos_mvcc_version *version = new spos_mvcc_version(_epoch.load(std::memory_order_relaxed) + 1);
+  version->obj.emplace(args...);
+  linkVersion(entry, version);
+  return finishWrite(version->epoch);
+}
+
+/**
+ * @brief Set a copy(!) of an object as a new version of this id's entry. This is similar
+ *        to addObjWithId() but using an object instead of args to create the stored object
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, based on which a copy is created and stored
+ * @return uint64_t  the epoch of this write
+ */
+template <class T>
+uint64_t spObjectMVCCStore<T>::setObjWithId(const std::string &id, const T &newObj)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  spos_mvcc_entry *entry = findOrCreateEntry(id);
+  spos_mvcc_version *version = new spos_mvcc_version(_epoch.load(std::memory_order_relaxed) + 1);
+  version->obj.emplace(newObj);
+  linkVersion(entry, version);
+  return finishWrite(version->epoch);
+}
+
+/**
+ * @brief Delete the object with the given id, i.e. add a deleted version of its entry,
+ *        and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template <class T>
+bool spObjectMVCCStore<T>::deleteObjById(const std::string &id)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  spos_mvcc_entry *entry = findEntry(_table.load(std::memory_order_relaxed), id);
+  if (entry == nullptr)
+  {
+    return false;
+  }
+  spos_mvcc_version *head = entry->head.load(std::memory_order_relaxed);
+  if ((head == nullptr) || !head->obj.has_value())
+  {
+    return false;
+  }
+  spos_mvcc_version *version = new spos_mvcc_version(_epoch.load(std::memory_order_relaxed) + 1);
+  linkVersion(entry, version);
+  finishWrite(version->epoch);
+  return true;
+}
+
+/**
+ * @brief Delete all objects with a single epoch, i.e. snapshots see either all or none
+ *        of the objects
+ *
+ */
+template <class T>
+void spObjectMVCCStore<T>::reset()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  uint64_t epoch = _epoch.load(std::memory_order_relaxed) + 1;
+  spos_mvcc_table *table = _table.load(std::memory_order_relaxed);
+  for (size_t i = 0; i <= table->mask; i++)
+  {
+    spos_mvcc_entry *entry = table->slots[i].load(std::memory_order_relaxed);
+    if ((entry == nullptr) || (entry == &_removed))
+    {
+      continue;
+    }
+    spos_mvcc_version *head = entry->head.load(std::memory_order_relaxed);
+    if ((head != nullptr) && head->obj.has_value())
+    {
+      linkVersion(entry, new spos_mvcc_version(epoch));
+    }
+  }
+  finishWrite(epoch);
+}
+
+/**
+ * @brief Take a snapshot of the store at the current epoch. Objects read via the snapshot
+ *        remain unchanged and valid until it is released or destroyed
+ *
+ * @return spObjectMVCCSnapshot<T>
+ */
+template <class T>
+spObjectMVCCSnapshot<T> spObjectMVCCStore<T>::getSnapshot()
+{
+  size_t slot = pinSlot();
+  uint64_t epoch = _epoch.load();
+  _readers[slot].store(epoch);
+  return spObjectMVCCSnapshot<T>(this, slot, epoch);
+}
+
+/**
+ * @brief Returns the epoch of the last write
+ *
+ * @return uint64_t
+ */
+template <class T>
+uint64_t spObjectMVCCStore<T>::getEpoch()
+{
+  return _epoch.load();
+}
+
+/**
+ * @brief Returns the number of objects stored at the current epoch
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::getSize()
+{
+  return _size.load();
+}
+
+/**
+ * @brief Returns true, if the last object set was added (i.e. new id) or false, if the
+ *        object replaced an existing one
+ *
+ * @return true / false
+ */
+template <class T>
+bool spObjectMVCCStore<T>::isAdded()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _added;
+}
+
+/**
+ * @brief Returns the number of versions kept, incl. older ones still visible to
+ *        snapshots and those not yet collected
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::getVersionCount()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _versionCount;
+}
+
+/**
+ * @brief Reclaim the versions no snapshot can see anymore, which is otherwise done
+ *        automatically by the writers, and return their number
+ *
+ * @return size_t  number of versions reclaimed
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::collect()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return collectLocked();
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * constructor of a hash table with all slots empty
+ *
+ * @param capacity  number of slots, a power of 2
+ */
+template <class T>
+spObjectMVCCStore<T>::spos_mvcc_table::spos_mvcc_table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<spos_mvcc_entry*>[capacity])
+{
+  for (size_t i = 0; i < capacity; i++)
+  {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Returns the entry with the given id in the table or nullptr. Used by readers
+ *        without locks, as writers only fill empty or removed slots and mark removed
+ *        entries without moving others
+ *
+ * @param table  the table to search
+ * @param id  id of the entry
+ * @return spos_mvcc_entry*
+ */
+template <class T>
+typename spObjectMVCCStore<T>::spos_mvcc_entry* spObjectMVCCStore<T>::findEntry(spos_mvcc_table *table, const std::string &id)
+{
+  size_t pos = std::hash<std::string>()(id) & table->mask;
+  while (true)
+  {
+    spos_mvcc_entry *entry = table->slots[pos].load(std::memory_order_acquire);
+    if (entry == nullptr)
+    {
+      return nullptr;
+    }
+    if ((entry != &_removed) && (entry->id == id))
+    {
+      return entry;
+    }
+    pos = (pos + 1) & table->mask;
+  }
+}
+
+/**
+ * @brief Returns the entry with the given id, which is created if not existing. The
+ *        table is kept at most half full, so that lookups always end at an empty slot
+ *
+ * @param id  id of the entry
+ * @return spos_mvcc_entry*
+ */
+template <class T>
+typename spObjectMVCCStore<T>::spos_mvcc_entry* spObjectMVCCStore<T>::findOrCreateEntry(const std::string &id)
+{
+  spos_mvcc_table *table = _table.load(std::memory_order_relaxed);
+  spos_mvcc_entry *entry = findEntry(table, id);
+  if (entry != nullptr)
+  {
+    return entry;
+  }
+  if ((table->used + 1) * 2 > table->mask + 1)
+  {
+    growTable();
+    table = _table.load(std::memory_order_relaxed);
+  }
+  entry = new spos_mvcc_entry(id);
+  size_t pos = std::hash<std::string>()(id) & table->mask;
+  while (true)
+  {
+    spos_mvcc_entry *slot = table->slots[pos].load(std::memory_order_relaxed);
+    if ((slot == nullptr) || (slot == &_removed))
+    {
+      if (slot == nullptr)
+      {
+        table->used++;
+      }
+      table->slots[pos].store(entry, std::memory_order_release);
+      return entry;
+    }
+    pos = (pos + 1) & table->mask;
+  }
+}
+
+/**
+ * @brief Replace the table with one of 4 times the size of the entries, without removed
+ *        markers. The old table is retired, as readers may still probe it
+ *
+ */
+template <class T>
+void spObjectMVCCStore<T>::growTable()
+{
+  spos_mvcc_table *table = _table.load(std::memory_order_relaxed);
+  size_t count = 0;
+  for (size_t i = 0; i <= table->mask; i++)
+  {
+    spos_mvcc_entry *entry = table->slots[i].load(std::memory_order_relaxed);
+    if ((entry != nullptr) && (entry != &_removed))
+    {
+      count++;
+    }
+  }
+  size_t capacity = 16;
+  while (capacity < 4 * (count + 1))
+  {
+    capacity *= 2;
+  }
+  spos_mvcc_table *newTable = new spos_mvcc_table(capacity);
+  for (size_t i = 0; i <= table->mask; i++)
+  {
+    spos_mvcc_entry *entry = table->slots[i].load(std::memory_order_relaxed);
+    if ((entry == nullptr) || (entry == &_removed))
+    {
+      continue;
+    }
+    size_t pos = std::hash<std::string>()(entry->id) & newTable->mask;
+    while (newTable->slots[pos].load(std::memory_order_relaxed) != nullptr)
+    {
+      pos = (pos + 1) & newTable->mask;
+    }
+    newTable->slots[pos].store(entry, std::memory_order_relaxed);
+    newTable->used++;
+  }
+  _table.store(newTable, std::memory_order_release);
+  _retiredTables.emplace_back(_epoch.load(std::memory_order_relaxed), table);
+}
+
+/**
+ * @brief Mark the entry's slot in the current table as removed
+ *
+ * @param entry  the entry to remove
+ */
+template <class T>
+void spObjectMVCCStore<T>::removeEntry(spos_mvcc_entry *entry)
+{
+  spos_mvcc_table *table = _table.load(std::memory_order_relaxed);
+  size_t pos = std::hash<std::string>()(entry->id) & table->mask;
+  while (true)
+  {
+    spos_mvcc_entry *slot = table->slots[pos].load(std::memory_order_relaxed);
+    if (slot == nullptr)
+    {
+      return;
+    }
+    if (slot == entry)
+    {
+      table->slots[pos].store(&_removed, std::memory_order_release);
+      return;
+    }
+    pos = (pos + 1) & table->mask;
+  }
+}
+
+/**
+ * @brief Make the version the newest of the entry, which readers only consider once
+ *        the epoch is published with finishWrite()
+ *
+ * @param entry  the entry written
+ * @param version  the new version
+ */
+template <class T>
+void spObjectMVCCStore<T>::linkVersion(spos_mvcc_entry *entry, spos_mvcc_version *version)
+{
+  spos_mvcc_version *head = entry->head.load(std::memory_order_relaxed);
+  bool wasStored = (head != nullptr) && head->obj.has_value();
+  _added = !wasStored;
+  version->older.store(head, std::memory_order_relaxed);
+  entry->head.store(version, std::memory_order_release);
+  _versionCount++;
+  if (wasStored && !version->obj.has_value())
+  {
+    _size.fetch_sub(1);
+  }
+  else if (!wasStored && version->obj.has_value())
+  {
+    _size.fetch_add(1);
+  }
+  if ((head != nullptr) && !entry->pending)
+  {
+    entry->pending = true;
+    _pending.push_back(entry);
+  }
+}
+
+/**
+ * @brief Publish the epoch of the versions linked, so that new snapshots see them, and
+ *        collect old versions after as many writes as entries with older versions, i.e.
+ *        at constant cost per write
+ *
+ * @param epoch  the epoch of the write
+ * @return uint64_t  the epoch of the write
+ */
+template <class T>
+uint64_t spObjectMVCCStore<T>::finishWrite(uint64_t epoch)
+{
+  _epoch.store(epoch);
+  _writesSinceGC++;
+  if (_writesSinceGC >= _gcThreshold)
+  {
+    collectLocked();
+    _writesSinceGC = 0;
+    _gcThreshold = (_pending.size() > 64) ? _pending.size() : 64;
+  }
+  return epoch;
+}
+
+/**
+ * @brief Returns the lowest epoch pinned by a snapshot or the current epoch. A slot
+ *        being pinned holds 0, so that nothing is collected until its epoch is known
+ *
+ * @return uint64_t
+ */
+template <class T>
+uint64_t spObjectMVCCStore<T>::getMinPinnedEpoch()
+{
+  uint64_t minEpoch = _epoch.load();
+  for (size_t i = 0; i < _maxReaders; i++)
+  {
+    uint64_t epoch = _readers[i].load();
+    if (epoch < minEpoch)
+    {
+      minEpoch = epoch;
+    }
+  }
+  return minEpoch;
+}
+
+/**
+ * @brief Reclaim the versions older than the newest version visible at the lowest pinned
+ *        epoch, remove entries deleted before this epoch and free entries and tables
+ *        retired before it
+ *
+ * @return size_t  number of versions reclaimed
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::collectLocked()
+{
+  uint64_t minEpoch = getMinPinnedEpoch();
+  uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+  size_t count = 0;
+  size_t kept = 0;
+  for (size_t i = 0; i < _pending.size(); i++)
+  {
+    spos_mvcc_entry *entry = _pending[i];
+    spos_mvcc_version *head = entry->head.load(std::memory_order_relaxed);
+    spos_mvcc_version *version = head;
+    while ((version != nullptr) && (version->epoch > minEpoch))
+    {
+      version = version->older.load(std::memory_order_relaxed);
+    }
+    if (version != nullptr)
+    {
+      // no snapshot reads beyond this version
+      count += deleteVersions(version->older.exchange(nullptr, std::memory_order_relaxed));
+      if ((version == head) && !head->obj.has_value())
+      {
+        removeEntry(entry);
+        _retiredEntries.emplace_back(epoch, entry);
+        continue;
+      }
+    }
+    if (head->older.load(std::memory_order_relaxed) != nullptr)
+    {
+      _pending[kept++] = entry;
+    }
+    else
+    {
+      entry->pending = false;
+    }
+  }
+  _pending.resize(kept);
+
+  kept = 0;
+  for (size_t i = 0; i < _retiredEntries.size(); i++)
+  {
+    if (_retiredEntries[i].first < minEpoch)
+    {
+      count += deleteEntry(_retiredEntries[i].second);
+    }
+    else
+    {
+      _retiredEntries[kept++] = _retiredEntries[i];
+    }
+  }
+  _retiredEntries.resize(kept);
+
+  kept = 0;
+  for (size_t i = 0; i < _retiredTables.size(); i++)
+  {
+    if (_retiredTables[i].first < minEpoch)
+    {
+      delete _retiredTables[i].second;
+    }
+    else
+    {
+      _retiredTables[kept++] = _retiredTables[i];
+    }
+  }
+  _retiredTables.resize(kept);
+  return count;
+}
+
+/**
+ * @brief Delete the version and all older ones
+ *
+ * @param version  the newest version to delete
+ * @return size_t  number of versions deleted
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::deleteVersions(spos_mvcc_version *version)
+{
+  size_t count = 0;
+  while (version != nullptr)
+  {
+    spos_mvcc_version *older = version->older.load(std::memory_order_relaxed);
+    delete version;
+    version = older;
+    count++;
+  }
+  _versionCount -= count;
+  return count;
+}
+
+/**
+ * @brief Delete the entry with all its versions
+ *
+ * @param entry  the entry to delete
+ * @return size_t  number of versions deleted
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::deleteEntry(spos_mvcc_entry *entry)
+{
+  size_t count = deleteVersions(entry->head.load(std::memory_order_relaxed));
+  delete entry;
+  return count;
+}
+
+/**
+ * @brief Take a free reader slot and mark it as being pinned, waiting if all slots are
+ *        in use
+ *
+ * @return size_t  the slot
+ */
+template <class T>
+size_t spObjectMVCCStore<T>::pinSlot()
+{
+  size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % _maxReaders;
+  while (true)
+  {
+    for (size_t i = 0; i < _maxReaders; i++)
+    {
+      size_t slot = (start + i) % _maxReaders;
+      uint64_t expected = UINT64_MAX;
+      if (_readers[slot].compare_exchange_strong(expected, 0))
+      {
+        return slot;
+      }
+    }
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * @brief Returns the object of the entry's newest version not newer than the epoch, or
+ *        nullptr if the entry was deleted or not yet added at this epoch
+ *
+ * @param entry  the entry
+ * @param epoch  the epoch of the snapshot
+ * @return const T*
+ */
+template <class T>
+const T* spObjectMVCCStore<T>::visibleObj(spos_mvcc_entry *entry, uint64_t epoch)
+{
+  spos_mvcc_version *version = entry->head.load(std::memory_order_acquire);
+  while ((version != nullptr) && (version->epoch > epoch))
+  {
+    version = version->older.load(std::memory_order_acquire);
+  }
+  if ((version == nullptr) || !version->obj.has_value())
+  {
+    return nullptr;
+  }
+  return &*version->obj;
+}
+
+
+/*    SNAPSHOT    SNAPSHOT    SNAPSHOT    SNAPSHOT    */
+
+
+/**
+ * constructor - used by spObjectMVCCStore::getSnapshot() with a pinned slot
+ */
+template <class T>
+spObjectMVCCSnapshot<T>::spObjectMVCCSnapshot(spObjectMVCCStore<T> *store, size_t slot, uint64_t epoch)
+{
+  _store = store;
+  _slot = slot;
+  _epoch = epoch;
+}
+
+/**
+ * move constructor - the other snapshot is released
+ */
+template <class T>
+spObjectMVCCSnapshot<T>::spObjectMVCCSnapshot(spObjectMVCCSnapshot<T> &&other)
+{
+  _store = other._store;
+  _slot = other._slot;
+  _epoch = other._epoch;
+  other._store = nullptr;
+}
+
+/**
+ * @brief Move assignment, releasing this snapshot and taking over the other one
+ *
+ * @param other  the snapshot to take over
+ * @return spObjectMVCCSnapshot<T>&
+ */
+template <class T>
+spObjectMVCCSnapshot<T>& spObjectMVCCSnapshot<T>::operator=(spObjectMVCCSnapshot<T> &&other)
+{
+  if (this != &other)
+  {
+    release();
+    _store = other._store;
+    _slot = other._slot;
+    _epoch = other._epoch;
+    other._store = nullptr;
+  }
+  return *this;
+}
+
+/**
+ * destructor - releases the snapshot
+ */
+template <class T>
+spObjectMVCCSnapshot<T>::~spObjectMVCCSnapshot()
+{
+  release();
+}
+
+/**
+ * @brief Get the object with the given id as of the snapshot's epoch and return a
+ *        pointer to it. If no object with this id exists, a nullptr is returned
+ *
+ * @param id  id of the object to find
+ * @return const T* pointer to object stored
+ */
+template <class T>
+const T* spObjectMVCCSnapshot<T>::getObjById(const std::string &id)
+{
+  if (_store == nullptr)
+  {
+    return nullptr;
+  }
+  auto *entry = _store->findEntry(_store->_table.load(std::memory_order_acquire), id);
+  if (entry == nullptr)
+  {
+    return nullptr;
+  }
+  return _store->visibleObj(entry, _epoch);
+}
+
+/**
+ * @brief Loop through all objects as of the snapshot's epoch and call function
+ *        callback(obj), until the callback returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T>
+void spObjectMVCCSnapshot<T>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Loop through all objects as of the snapshot's epoch and call function
+ *        callback(id, obj), until the callback returns false
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectMVCCSnapshot<T>::forEach(spos_forEach_IO_callback callback)
+{
+  if (_store == nullptr)
+  {
+    return;
+  }
+  auto *table = _store->_table.load(std::memory_order_acquire);
+  for (size_t i = 0; i <= table->mask; i++)
+  {
+    auto *entry = table->slots[i].load(std::memory_order_acquire);
+    if ((entry == nullptr) || (entry == &_store->_removed))
+    {
+      continue;
+    }
+    const T *obj = _store->visibleObj(entry, _epoch);
+    if ((obj != nullptr) && !callback(entry->id, *obj))
+    {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Returns the number of objects as of the snapshot's epoch, which requires to
+ *        loop through all entries
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectMVCCSnapshot<T>::getSize()
+{
+  size_t count = 0;
+  forEach([&count](const std::string &, const T &) { count++; return true; });
+  return count;
+}
+
+/**
+ * @brief Returns the epoch the snapshot sees the store at
+ *
+ * @return uint64_t
+ */
+template <class T>
+uint64_t spObjectMVCCSnapshot<T>::getEpoch()
+{
+  return _epoch;
+}
+
+/**
+ * @brief Release the snapshot, after which the versions only it could see may be
+ *        reclaimed and its objects must not be used anymore
+ *
+ */
+template <class T>
+void spObjectMVCCSnapshot<T>::release()
+{
+  if (_store != nullptr)
+  {
+    _store->_readers[_slot].store(UINT64_MAX);
+    _store = nullptr;
+  }
+}
+
+
+#endif
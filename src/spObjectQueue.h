@@ -0,0 +1,507 @@
+/**
+ * @file spObjectQueue.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated priority queue class to add, retrieve, update and pop objects by id
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTQUEUE_H_
+#define SPOBJECTQUEUE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <functional>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+
+/**
+ *  Notes:
+ *  - the queue is the heap based counterpart of a spObjectStore sorted by a compare callback,
+ *    whereby only the entry with the lowest value (the head) is kept in order, which allows
+ *    to pop the head and to update an entry's position in O(log n)
+ *  - ids are mapped to heap positions, so that lookups by id are O(1)
+ *  - entries with the same value are ordered by their ids
+ *
+*/
+
+
+/**
+ * @brief the priority queue class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectQueue
+{
+   public:
+    /*  typedef for comparison function
+        int myCmpFunc(const T &obj_A, const T &obj_B);
+        return value: <0 = A has lower value, 0 = same, >0 = A has higher value   */
+    typedef std::function<int(const T&, const T&)> spos_compare_callback;
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    struct spos_queue_entry
+    {
+      std::string id;
+      T obj;
+      template <class... Vs>
+      spos_queue_entry(const std::string &entryId, Vs&&... args) : id(entryId), obj(std::forward<Vs>(args)...) {}
+    };
+    std::vector<spos_queue_entry> _heap;
+    std::unordered_map<std::string, size_t> _positions;
+    spos_compare_callback _compareCB;
+    bool _added = false;
+
+    bool isLower(size_t posA, size_t posB);
+    void swapEntries(size_t posA, size_t posB);
+    size_t siftUp(size_t pos);
+    size_t siftDown(size_t pos);
+    void removeAt(size_t pos);
+
+   public:
+    spObjectQueue(spos_compare_callback callback);
+    template <class... Vs>
+    T* addObjWithId(const std::string &id, Vs... args);
+    T* setObjWithId(const std::string &id, T &newObj);
+    T* getObjById(const std::string &id);
+    T* peekMin();
+    std::string peekMinId();
+    bool popMin();
+    bool popMin(std::string &id, T &obj);
+    bool decreaseKey(const std::string &id);
+    bool updateKey(const std::string &id);
+    bool deleteObjById(const std::string &id);
+    void reset();
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+    bool isAdded();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor - ordering by comparison callback, lowest value on top
+ */
+template <class T>
+spObjectQueue<T>::spObjectQueue(spos_compare_callback callback)
+{
+  _compareCB = callback;
+}
+
+/**
+ * @brief Create an object, add it with the given id and return a pointer to it.
+ *        If an object with this id already exists, then a new object is
+ *        stored under this id and its position in the queue updated.
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return T* pointer to object stored
+ */
+template<class T> template<class... Vs>
+T* spObjectQueue<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  auto it = _positions.find(id);
+  size_t pos;
+  if (it == _positions.end()){
+    _added = true;
+    pos = _heap.size();
+    _heap.emplace_back(id, args...);
+    _positions[id] = pos;
+  } else {
+    _added = false;
+    pos = it->second;
+    _heap[pos].obj = T(args...);
+    pos = siftDown(pos);
+  }
+  pos = siftUp(pos);
+  return &_heap[pos].obj;
+}
+
+/**
+ * @brief Set a copy(!) of an object with the given id, which is either replacing
+ *        an existing one or adding a new id - object pair. This is similar to
+ *        addObjWithId() but using an object instead of args to create the stored object
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, based on which a copy is created and stored
+ */
+template <class T>
+T* spObjectQueue<T>::setObjWithId(const std::string &id, T &newObj)
+{
+  auto it = _positions.find(id);
+  size_t pos;
+  if (it == _positions.end()){
+    _added = true;
+    pos = _heap.size();
+    _heap.emplace_back(id, newObj);
+    _positions[id] = pos;
+  } else {
+    _added = false;
+    pos = it->second;
+    _heap[pos].obj = newObj;
+    pos = siftDown(pos);
+  }
+  pos = siftUp(pos);
+  return &_heap[pos].obj;
+}
+
+/**
+ * @brief Get an object with the given id and return a pointer to it.
+ *        If no object with this id exists, a nullptr is returned.
+ *        When changing the object's values via the pointer, call decreaseKey() or
+ *        updateKey() afterwards to restore its position in the queue
+ *
+ * @param id  id of the object to find
+ * @return T* pointer to object stored
+ */
+template<class T>
+T* spObjectQueue<T>::getObjById(const std::string &id)
+{
+  auto it = _positions.find(id);
+  if (it == _positions.end()){
+    return nullptr;
+  }
+  return &_heap[it->second].obj;
+}
+
+/**
+ * @brief Returns a pointer to the object with the lowest value or a nullptr if the
+ *        queue is empty
+ *
+ * @return T* pointer to object stored
+ */
+template<class T>
+T* spObjectQueue<T>::peekMin()
+{
+  if (_heap.size() == 0){
+    return nullptr;
+  }
+  return &_heap[0].obj;
+}
+
+/**
+ * @brief Returns the id of the object with the lowest value or an empty string if the
+ *        queue is empty
+ *
+ * @return std::string  the id of the object stored
+ */
+template<class T>
+std::string spObjectQueue<T>::peekMinId()
+{
+  if (_heap.size() == 0){
+    return "";
+  }
+  return _heap[0].id;
+}
+
+/**
+ * @brief Delete the object with the lowest value and return success
+ *
+ * @return true / false
+ */
+template<class T>
+bool spObjectQueue<T>::popMin()
+{
+  if (_heap.size() == 0){
+    return false;
+  }
+  removeAt(0);
+  return true;
+}
+
+/**
+ * @brief Move the object with the lowest value and its id out of the queue into the
+ *        arguments given and return success
+ *
+ * @param id  receives the id of the object removed
+ * @param obj  receives the object removed
+ * @return true / false
+ */
+template<class T>
+bool spObjectQueue<T>::popMin(std::string &id, T &obj)
+{
+  if (_heap.size() == 0){
+    return false;
+  }
+  id = _heap[0].id;
+  obj = std::move(_heap[0].obj);
+  removeAt(0);
+  return true;
+}
+
+/**
+ * @brief Restore the position of an object after its value was lowered via the pointer
+ *        obtained from getObjById() and return success
+ *
+ * @param id  id of the object changed
+ * @return true / false
+ */
+template<class T>
+bool spObjectQueue<T>::decreaseKey(const std::string &id)
+{
+  auto it = _positions.find(id);
+  if (it == _positions.end()){
+    return false;
+  }
+  siftUp(it->second);
+  return true;
+}
+
+/**
+ * @brief Restore the position of an object after its value was changed in any direction
+ *        via the pointer obtained from getObjById() and return success
+ *
+ * @param id  id of the object changed
+ * @return true / false
+ */
+template<class T>
+bool spObjectQueue<T>::updateKey(const std::string &id)
+{
+  auto it = _positions.find(id);
+  if (it == _positions.end()){
+    return false;
+  }
+  siftUp(siftDown(it->second));
+  return true;
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template<class T>
+bool spObjectQueue<T>::deleteObjById(const std::string &id)
+{
+  auto it = _positions.find(id);
+  if (it == _positions.end()){
+    return false;
+  }
+  removeAt(it->second);
+  return true;
+}
+
+/**
+ * @brief Delete all objects
+ *
+ */
+template <class T>
+void spObjectQueue<T>::reset()
+{
+  _heap.clear();
+  _positions.clear();
+}
+
+/**
+ * @brief Loop through all entries in heap order (i.e. only the first one is guaranteed
+ *        to have the lowest value) and call function callback(obj)
+ *
+ * @param callback  function of type func(const class &obj)
+ */
+template <class T>
+void spObjectQueue<T>::forEach(spos_forEach_O_callback callback)
+{
+  size_t count = _heap.size();
+  for (size_t i = 0; i < count; i++) {
+    if (callback(_heap[i].obj) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Loop through all entries in heap order (i.e. only the first one is guaranteed
+ *        to have the lowest value) and call function callback(id, obj)
+ *
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectQueue<T>::forEach(spos_forEach_IO_callback callback)
+{
+  size_t count = _heap.size();
+  for (size_t i = 0; i < count; i++) {
+    if (callback(_heap[i].id, _heap[i].obj) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Returns the number of objects in the queue
+ *
+ * @return size_t number
+ */
+template <class T>
+size_t spObjectQueue<T>::getSize()
+{
+  return _heap.size();
+}
+
+/**
+ * @brief Returns the status of last call to addObjWithId() and setObjWithId() with
+ *        regard to a new entry having been added
+ *
+ * @return true / false
+ */
+template <class T>
+bool spObjectQueue<T>::isAdded()
+{
+  return _added;
+}
+
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+
+/**
+ * @brief Returns whether the entry at posA has a lower value than the one at posB,
+ *        with ids deciding for same values
+ *
+ * @param posA
+ * @param posB
+ * @return true / false
+ */
+template <class T>
+bool spObjectQueue<T>::isLower(size_t posA, size_t posB)
+{
+  int cmpRes = _compareCB(_heap[posA].obj, _heap[posB].obj);
+  if (cmpRes == 0)
+  {
+    cmpRes = strcmp(_heap[posA].id.c_str(), _heap[posB].id.c_str());
+  }
+  return cmpRes < 0;
+}
+
+/**
+ * @brief Swap two entries and update their positions
+ *
+ * @param posA
+ * @param posB
+ */
+template <class T>
+void spObjectQueue<T>::swapEntries(size_t posA, size_t posB)
+{
+  std::swap(_heap[posA], _heap[posB]);
+  _positions[_heap[posA].id] = posA;
+  _positions[_heap[posB].id] = posB;
+}
+
+/**
+ * @brief Move the entry at pos up until its parent is lower and return its new position
+ *
+ * @param pos
+ * @return size_t
+ */
+template <class T>
+size_t spObjectQueue<T>::siftUp(size_t pos)
+{
+  while (pos > 0)
+  {
+    size_t parent = (pos - 1) / 2;
+    if (!isLower(pos, parent))
+    {
+      break;
+    }
+    swapEntries(pos, parent);
+    pos = parent;
+  }
+  return pos;
+}
+
+/**
+ * @brief Move the entry at pos down until its children are higher and return its new position
+ *
+ * @param pos
+ * @return size_t
+ */
+template <class T>
+size_t spObjectQueue<T>::siftDown(size_t pos)
+{
+  size_t count = _heap.size();
+  while (true)
+  {
+    size_t lowest = pos;
+    size_t child = 2 * pos + 1;
+    if ((child < count) && isLower(child, lowest))
+    {
+      lowest = child;
+    }
+    child++;
+    if ((child < count) && isLower(child, lowest))
+    {
+      lowest = child;
+    }
+    if (lowest == pos)
+    {
+      break;
+    }
+    swapEntries(pos, lowest);
+    pos = lowest;
+  }
+  return pos;
+}
+
+/**
+ * @brief Remove the entry at pos by moving the last entry into its place
+ *
+ * @param pos
+ */
+template <class T>
+void spObjectQueue<T>::removeAt(size_t pos)
+{
+  size_t last = _heap.size() - 1;
+  if (pos != last)
+  {
+    swapEntries(pos, last);
+  }
+  _positions.erase(_heap[last].id);
+  _heap.pop_back();
+  if (pos < last)
+  {
+    siftUp(siftDown(pos));
+  }
+}
+
+#endif // SPOBJECTQUEUE_H_
@@ -0,0 +1,480 @@
+/**
+ * @file spObjectSeqLockStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated store class for small, rarely written stores, whose readers copy objects
+ *        optimistically, i.e. without writing to shared memory
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTSEQLOCKSTORE_H_
+#define SPOBJECTSEQLOCKSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <type_traits>
+
+
+/**
+ *  Notes:
+ *  - writers are serialized by a mutex and increase a sequence counter before (to an odd
+ *    value) and after (to an even value) each change
+ *  - readers only read: they copy an object and retry, if the sequence counter was odd or
+ *    changed meanwhile, i.e. reads never wait for each other and never write shared cache
+ *    lines, while a write makes concurrent reads retry
+ *  - objects must be trivially copyable, as they may be copied while being written (such
+ *    copies are discarded), and are kept in atomic words, so that this is no data race
+ *  - ids are mapped to entries, which are never moved or freed until the store is
+ *    destroyed, by a hash table, which is only replaced (and kept) when growing. Entries of
+ *    deleted objects are reused when their id is added again
+ *
+*/
+
+
+/**
+ * @brief the seqlock store class
+ * @tparam T  class typename of objects to store, which must be trivially copyable
+ */
+template <class T>
+class spObjectSeqLockStore
+{
+    static_assert(std::is_trivially_copyable<T>::value, "spObjectSeqLockStore requires a trivially copyable class");
+
+   public:
+    /*  typedef for visiting function
+        void myVisitFunc(const T &obj);  */
+    typedef std::function<void(const T&)> spos_visit_callback;
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    static constexpr size_t SPOS_SEQ_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    struct spos_seq_entry
+    {
+      const std::string id;
+      std::atomic<bool> stored;
+      std::atomic<uint64_t> words[SPOS_SEQ_WORDS];
+      spos_seq_entry(const std::string &entryId) : id(entryId), stored(false) {}
+    };
+    struct spos_seq_table
+    {
+      size_t mask;
+      std::unique_ptr<std::atomic<spos_seq_entry*>[]> slots;
+      spos_seq_table(size_t capacity);
+    };
+
+    std::mutex _mutex;
+    std::atomic<uint64_t> _seq;
+    std::atomic<spos_seq_table*> _table;
+    std::atomic<size_t> _size;
+    std::vector<std::unique_ptr<spos_seq_table>> _tables;
+    std::vector<std::unique_ptr<spos_seq_entry>> _entries;
+    bool _added = false;
+
+    spos_seq_entry* findEntry(spos_seq_table *table, const std::string &id);
+    void writeObj(const std::string &id, const T &obj);
+    void beginWrite();
+    void endWrite();
+    static void copyObj(spos_seq_entry *entry, T &obj);
+
+   public:
+    spObjectSeqLockStore();
+    spObjectSeqLockStore(const spObjectSeqLockStore<T> &other) = delete;
+    spObjectSeqLockStore<T>& operator=(const spObjectSeqLockStore<T> &other) = delete;
+    template <class... Vs>
+    bool addObjWithId(const std::string &id, Vs... args);
+    bool setObjWithId(const std::string &id, const T &newObj);
+    bool deleteObjById(const std::string &id);
+    void reset();
+    bool getObjById(const std::string &id, T &obj);
+    bool visitObjById(const std::string &id, spos_visit_callback callback);
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ */
+template <class T>
+spObjectSeqLockStore<T>::spObjectSeqLockStore() : _seq(0), _size(0)
+{
+  _tables.emplace_back(new spos_seq_table(16));
+  _table.store(_tables.back().get());
+}
+
+/**
+ * @brief Create an object and store it with the given id. If an object with this id
+ *        already exists, then it is replaced by the new object
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return true if the id was added, false if an object was replaced
+ */
+template<class T> template<class... Vs>
+bool spObjectSeqLockStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  T newObj(args...);
+  std::lock_guard<std::mutex> lock(_mutex);
+  writeObj(id, newObj);
+  return _added;
+}
+
+/**
+ * @brief Store a copy(!) of an object with the given id, which is either replacing an
+ *        existing one or adding a new id - object pair
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is copied
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T>
+bool spObjectSeqLockStore<T>::setObjWithId(const std::string &id, const T &newObj)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  writeObj(id, newObj);
+  return _added;
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template <class T>
+bool spObjectSeqLockStore<T>::deleteObjById(const std::string &id)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  spos_seq_entry *entry = findEntry(_table.load(std::memory_order_relaxed), id);
+  if ((entry == nullptr) || !entry->stored.load(std::memory_order_relaxed))
+  {
+    return false;
+  }
+  beginWrite();
+  entry->stored.store(false, std::memory_order_relaxed);
+  endWrite();
+  _size.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+/**
+ * @brief Delete all objects
+ *
+ */
+template <class T>
+void spObjectSeqLockStore<T>::reset()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  beginWrite();
+  for (size_t i = 0; i < _entries.size(); i++)
+  {
+    _entries[i]->stored.store(false, std::memory_order_relaxed);
+  }
+  endWrite();
+  _size.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Copy the object with the given id into obj and return success. The copy is
+ *        repeated, if a write happened meanwhile
+ *
+ * @param id  id of the object to find
+ * @param obj  object to copy the stored object to
+ * @return true / false
+ */
+template <class T>
+bool spObjectSeqLockStore<T>::getObjById(const std::string &id, T &obj)
+{
+  spos_seq_entry *entry = findEntry(_table.load(std::memory_order_acquire), id);
+  if (entry == nullptr)
+  {
+    return false;
+  }
+  while (true)
+  {
+    uint64_t seq = _seq.load(std::memory_order_acquire);
+    if ((seq & 1) == 0)
+    {
+      bool stored = entry->stored.load(std::memory_order_relaxed);
+      copyObj(entry, obj);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) == seq)
+      {
+        return stored;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Call callback(obj) with a consistent copy of the object with the given id and
+ *        return success
+ *
+ * @param id  id of the object to find
+ * @param callback  function of type void func(const class &obj)
+ * @return true / false
+ */
+template <class T>
+bool spObjectSeqLockStore<T>::visitObjById(const std::string &id, spos_visit_callback callback)
+{
+  T obj;
+  if (!getObjById(id, obj))
+  {
+    return false;
+  }
+  callback(obj);
+  return true;
+}
+
+/**
+ * @brief Loop through all objects and call function callback(obj), until the callback
+ *        returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T>
+void spObjectSeqLockStore<T>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Loop through all objects and call function callback(id, obj), until the
+ *        callback returns false. All objects are copied first, and again if a write
+ *        happened meanwhile, so that the callback sees the objects at a single point in
+ *        time. The order is not sorted
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectSeqLockStore<T>::forEach(spos_forEach_IO_callback callback)
+{
+  std::vector<spos_seq_entry*> entries;
+  std::vector<T> objects;
+  while (true)
+  {
+    entries.clear();
+    objects.clear();
+    uint64_t seq = _seq.load(std::memory_order_acquire);
+    if ((seq & 1) != 0)
+    {
+      continue;
+    }
+    spos_seq_table *table = _table.load(std::memory_order_acquire);
+    for (size_t i = 0; i <= table->mask; i++)
+    {
+      spos_seq_entry *entry = table->slots[i].load(std::memory_order_acquire);
+      if ((entry != nullptr) && entry->stored.load(std::memory_order_relaxed))
+      {
+        entries.push_back(entry);
+        objects.emplace_back();
+        copyObj(entry, objects.back());
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_seq.load(std::memory_order_relaxed) == seq)
+    {
+      break;
+    }
+  }
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    if (!callback(entries[i]->id, objects[i]))
+    {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Returns the number of objects stored
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectSeqLockStore<T>::getSize()
+{
+  return _size.load(std::memory_order_relaxed);
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * constructor of a hash table with all slots empty
+ *
+ * @param capacity  number of slots, a power of 2
+ */
+template <class T>
+spObjectSeqLockStore<T>::spos_seq_table::spos_seq_table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<spos_seq_entry*>[capacity])
+{
+  for (size_t i = 0; i < capacity; i++)
+  {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Returns the entry with the given id in the table or nullptr. Used by readers,
+ *        as slots are only filled once
+ *
+ * @param table  the table to search
+ * @param id  id of the entry
+ * @return spos_seq_entry*
+ */
+template <class T>
+typename spObjectSeqLockStore<T>::spos_seq_entry* spObjectSeqLockStore<T>::findEntry(spos_seq_table *table, const std::string &id)
+{
+  size_t pos = std::hash<std::string>()(id) & table->mask;
+  while (true)
+  {
+    spos_seq_entry *entry = table->slots[pos].load(std::memory_order_acquire);
+    if ((entry == nullptr) || (entry->id == id))
+    {
+      return entry;
+    }
+    pos = (pos + 1) & table->mask;
+  }
+}
+
+/**
+ * @brief Write the object to the entry with this id, which is created first if not
+ *        existing. A new table of twice the size is published, when the table becomes
+ *        half full
+ *
+ * @param id  id of the object
+ * @param obj  the object
+ */
+template <class T>
+void spObjectSeqLockStore<T>::writeObj(const std::string &id, const T &obj)
+{
+  spos_seq_table *table = _table.load(std::memory_order_relaxed);
+  spos_seq_entry *entry = findEntry(table, id);
+  if (entry == nullptr)
+  {
+    if ((_entries.size() + 1) * 2 > table->mask + 1)
+    {
+      _tables.emplace_back(new spos_seq_table(2 * (table->mask + 1)));
+      spos_seq_table *newTable = _tables.back().get();
+      for (size_t i = 0; i < _entries.size(); i++)
+      {
+        size_t pos = std::hash<std::string>()(_entries[i]->id) & newTable->mask;
+        while (newTable->slots[pos].load(std::memory_order_relaxed) != nullptr)
+        {
+          pos = (pos + 1) & newTable->mask;
+        }
+        newTable->slots[pos].store(_entries[i].get(), std::memory_order_relaxed);
+      }
+      _table.store(newTable, std::memory_order_release);
+      table = newTable;
+    }
+    _entries.emplace_back(new spos_seq_entry(id));
+    entry = _entries.back().get();
+    size_t pos = std::hash<std::string>()(id) & table->mask;
+    while (table->slots[pos].load(std::memory_order_relaxed) != nullptr)
+    {
+      pos = (pos + 1) & table->mask;
+    }
+    table->slots[pos].store(entry, std::memory_order_release);
+  }
+
+  uint64_t words[SPOS_SEQ_WORDS] = {};
+  memcpy(words, &obj, sizeof(T));
+  _added = !entry->stored.load(std::memory_order_relaxed);
+  beginWrite();
+  for (size_t i = 0; i < SPOS_SEQ_WORDS; i++)
+  {
+    entry->words[i].store(words[i], std::memory_order_relaxed);
+  }
+  entry->stored.store(true, std::memory_order_relaxed);
+  endWrite();
+  if (_added)
+  {
+    _size.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * @brief Make the sequence counter odd, so that readers retry
+ *
+ */
+template <class T>
+void spObjectSeqLockStore<T>::beginWrite()
+{
+  _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**
+ * @brief Make the sequence counter even again, with the changes visible to readers
+ *
+ */
+template <class T>
+void spObjectSeqLockStore<T>::endWrite()
+{
+  _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Copy the entry's words into obj, which is only valid if the sequence counter
+ *        did not change meanwhile
+ *
+ * @param entry  the entry
+ * @param obj  the object to copy to
+ */
+template <class T>
+void spObjectSeqLockStore<T>::copyObj(spos_seq_entry *entry, T &obj)
+{
+  uint64_t words[SPOS_SEQ_WORDS];
+  for (size_t i = 0; i < SPOS_SEQ_WORDS; i++)
+  {
+    words[i] = entry->words[i].load(std::memory_order_relaxed);
+  }
+  memcpy(&obj, words, sizeof(T));
+}
+
+
+#endif
@@ -0,0 +1,727 @@
+/**
+ * @file spObjectSkipListStore.h
+ * @author krokoreit (krokoreit@gmail.com)
+ * @brief a templated store class sorted by ids, which is based on a lock-free skip list for
+ *        concurrent reads and writes from many threads
+ * @version 2.2.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+
+#ifndef SPOBJECTSKIPLISTSTORE_H_
+#define SPOBJECTSKIPLISTSTORE_H_
+
+
+#include <stdint.h>
+#include <string>
+#include <string.h>
+#include <functional>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <memory>
+
+#include <spObjectStore.h>
+
+
+/**
+ *  Notes:
+ *  - entries are kept in a skip list sorted by their ids, whereby all threads add, replace,
+ *    delete and find entries without locks
+ *  - an entry is deleted by marking its links (top level first), after which any thread
+ *    passing it unlinks it, and it is only added again as a new entry
+ *  - objects are replaced as a whole, i.e. readers copy or iterate objects which are not
+ *    changed anymore
+ *  - unlinked entries and replaced objects are freed once no thread can reach them anymore
+ *    (epoch based reclamation): each call pins the global epoch in a thread slot and memory
+ *    retired at an epoch is freed, when all pinned threads are at least 2 epochs ahead
+ *  - forEach() runs while other threads continue, i.e. it sees entries changed meanwhile
+ *    either before or after the change, but always in the order of their ids
+ *
+*/
+
+
+/**
+ * @brief the skip list store class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectSkipListStore
+{
+   public:
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+
+   private:
+    static constexpr int SPOS_SKIP_MAX_LEVEL = 24;
+    struct spos_skip_node
+    {
+      std::string id;
+      std::atomic<T*> obj;
+      int height;
+      std::unique_ptr<std::atomic<uintptr_t>[]> next;     // lowest bit marks deletion
+      spos_skip_node(const std::string &nodeId, T *nodeObj, int nodeHeight);
+      ~spos_skip_node();
+    };
+    struct spos_skip_retired
+    {
+      uint64_t epoch;
+      spos_skip_node *node;
+      T *obj;
+    };
+    struct alignas(64) spos_skip_slot
+    {
+      std::atomic<uint64_t> epoch;                          // UINT64_MAX when free
+      std::vector<spos_skip_retired> retired;
+      size_t collectAt = 64;
+    };
+
+    spos_skip_node *_head;
+    sposSort _sorting;
+    std::atomic<size_t> _size;
+    std::atomic<uint64_t> _epoch;
+    std::unique_ptr<spos_skip_slot[]> _slots;
+    size_t _maxThreads;
+
+    static spos_skip_node* nodeOf(uintptr_t link);
+    static bool isMarked(uintptr_t link);
+    int32_t compareIds(const std::string &id1, const std::string &id2);
+    int randomHeight();
+    bool find(const std::string &id, spos_skip_node **preds, spos_skip_node **succs);
+    void unlinkMarked(const std::string &id);
+    bool insertObj(size_t slot, const std::string &id, T *obj);
+    size_t pin();
+    void unpin(size_t slot);
+    void retire(size_t slot, spos_skip_node *node, T *obj);
+    uint64_t advanceEpoch();
+    void collectSlot(size_t slot);
+
+   public:
+    spObjectSkipListStore(sposSort sorting = ASC, size_t maxThreads = 128);
+    spObjectSkipListStore(const spObjectSkipListStore<T> &other) = delete;
+    spObjectSkipListStore<T>& operator=(const spObjectSkipListStore<T> &other) = delete;
+    ~spObjectSkipListStore();
+    template <class... Vs>
+    bool addObjWithId(const std::string &id, Vs... args);
+    bool setObjWithId(const std::string &id, const T &newObj);
+    bool getObjById(const std::string &id, T &obj);
+    bool deleteObjById(const std::string &id);
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    size_t getSize();
+    sposSort getSorting();
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx
+
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor
+ *
+ * @param sorting  ASC or DESC (None is handled as ASC)
+ * @param maxThreads  maximum number of threads calling the store at the same time, further
+ *                    threads wait for a slot
+ */
+template <class T>
+spObjectSkipListStore<T>::spObjectSkipListStore(sposSort sorting, size_t maxThreads) : _size(0), _epoch(1)
+{
+  _head = new spos_skip_node("", nullptr, SPOS_SKIP_MAX_LEVEL);
+  _sorting = (sorting == DESC) ? DESC : ASC;
+  _maxThreads = (maxThreads > 0) ? maxThreads : 1;
+  _slots.reset(new spos_skip_slot[_maxThreads]);
+  for (size_t i = 0; i < _maxThreads; i++)
+  {
+    _slots[i].epoch.store(UINT64_MAX);
+  }
+}
+
+/**
+ * destructor - no other thread may use the store anymore
+ */
+template <class T>
+spObjectSkipListStore<T>::~spObjectSkipListStore()
+{
+  spos_skip_node *node = _head;
+  while (node != nullptr)
+  {
+    spos_skip_node *next = nodeOf(node->next[0].load());
+    delete node;
+    node = next;
+  }
+  for (size_t i = 0; i < _maxThreads; i++)
+  {
+    for (size_t j = 0; j < _slots[i].retired.size(); j++)
+    {
+      delete _slots[i].retired[j].node;
+      delete _slots[i].retired[j].obj;
+    }
+  }
+}
+
+/**
+ * @brief Create an object and add it with the given id. If an object with this id already
+ *        exists, then it is replaced by the new object
+ *
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return true if the id was added, false if an object was replaced
+ */
+template<class T> template<class... Vs>
+bool spObjectSkipListStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  size_t slot = pin();
+  bool added = insertObj(slot, id, new T(args...));
+  unpin(slot);
+  return added;
+}
+
+/**
+ * @brief Set a copy(!) of an object with the given id, which is either replacing an
+ *        existing one or adding a new id - object pair. This is similar to addObjWithId()
+ *        but using an object instead of args to create the stored object
+ *
+ * @param id  id of the object to store
+ * @param newObj an object of class T, based on which a copy is created and stored
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T>
+bool spObjectSkipListStore<T>::setObjWithId(const std::string &id, const T &newObj)
+{
+  size_t slot = pin();
+  bool added = insertObj(slot, id, new T(newObj));
+  unpin(slot);
+  return added;
+}
+
+/**
+ * @brief Copy the object with the given id into obj and return success. A copy is
+ *        returned instead of a pointer, as other threads may replace or delete the
+ *        stored object at any time
+ *
+ * @param id  id of the object to find
+ * @param obj  object to copy the stored object to
+ * @return true / false
+ */
+template <class T>
+bool spObjectSkipListStore<T>::getObjById(const std::string &id, T &obj)
+{
+  spos_skip_node *preds[SPOS_SKIP_MAX_LEVEL];
+  spos_skip_node *succs[SPOS_SKIP_MAX_LEVEL];
+  size_t slot = pin();
+  bool found = find(id, preds, succs);
+  if (found)
+  {
+    obj = *succs[0]->obj.load();
+  }
+  unpin(slot);
+  return found;
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ *
+ * @param id  id of the object to delete
+ * @return true / false
+ */
+template <class T>
+bool spObjectSkipListStore<T>::deleteObjById(const std::string &id)
+{
+  spos_skip_node *preds[SPOS_SKIP_MAX_LEVEL];
+  spos_skip_node *succs[SPOS_SKIP_MAX_LEVEL];
+  size_t slot = pin();
+  if (!find(id, preds, succs))
+  {
+    unpin(slot);
+    return false;
+  }
+  spos_skip_node *node = succs[0];
+  for (int level = node->height - 1; level > 0; level--)
+  {
+    uintptr_t link = node->next[level].load();
+    while (!isMarked(link) && !node->next[level].compare_exchange_weak(link, link | 1))
+    {
+    }
+  }
+  // the thread marking the lowest level deletes the entry
+  uintptr_t link = node->next[0].load();
+  while (true)
+  {
+    if (isMarked(link))
+    {
+      unpin(slot);
+      return false;
+    }
+    if (node->next[0].compare_exchange_weak(link, link | 1))
+    {
+      break;
+    }
+  }
+  _size.fetch_sub(1);
+  unlinkMarked(id);
+  retire(slot, node, nullptr);
+  unpin(slot);
+  return true;
+}
+
+/**
+ * @brief Loop through all entries in the order of their ids and call function
+ *        callback(obj), until the callback returns false
+ *
+ * @param callback  function of type bool func(const class &obj)
+ */
+template <class T>
+void spObjectSkipListStore<T>::forEach(spos_forEach_O_callback callback)
+{
+  forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+}
+
+/**
+ * @brief Loop through all entries in the order of their ids and call function
+ *        callback(id, obj), until the callback returns false. Memory is not freed
+ *        while looping, so long running callbacks should be avoided
+ *
+ * @param callback  function of type bool func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectSkipListStore<T>::forEach(spos_forEach_IO_callback callback)
+{
+  size_t slot = pin();
+  spos_skip_node *node = nodeOf(_head->next[0].load());
+  while (node != nullptr)
+  {
+    uintptr_t link = node->next[0].load();
+    if (!isMarked(link) && !callback(node->id, *node->obj.load()))
+    {
+      break;
+    }
+    node = nodeOf(link);
+  }
+  unpin(slot);
+}
+
+/**
+ * @brief Returns the number of stored objects, which may change at any time by other
+ *        threads
+ *
+ * @return size_t
+ */
+template <class T>
+size_t spObjectSkipListStore<T>::getSize()
+{
+  return _size.load();
+}
+
+/**
+ * @brief Returns the sorting of the ids, ASC or DESC
+ *
+ * @return sposSort
+ */
+template <class T>
+sposSort spObjectSkipListStore<T>::getSorting()
+{
+  return _sorting;
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+/**
+ * constructor of a node with all links empty
+ */
+template <class T>
+spObjectSkipListStore<T>::spos_skip_node::spos_skip_node(const std::string &nodeId, T *nodeObj, int nodeHeight) : id(nodeId), obj(nodeObj), height(nodeHeight), next(new std::atomic<uintptr_t>[nodeHeight])
+{
+  for (int i = 0; i < nodeHeight; i++)
+  {
+    next[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+/**
+ * destructor of a node, deleting its object
+ */
+template <class T>
+spObjectSkipListStore<T>::spos_skip_node::~spos_skip_node()
+{
+  delete obj.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the node of a link without the deletion mark
+ *
+ * @param link  the link
+ * @return spos_skip_node*
+ */
+template <class T>
+typename spObjectSkipListStore<T>::spos_skip_node* spObjectSkipListStore<T>::nodeOf(uintptr_t link)
+{
+  return reinterpret_cast<spos_skip_node*>(link & ~static_cast<uintptr_t>(1));
+}
+
+/**
+ * @brief Returns whether the link is marked, i.e. the node holding it is being deleted
+ *
+ * @param link  the link
+ * @return true / false
+ */
+template <class T>
+bool spObjectSkipListStore<T>::isMarked(uintptr_t link)
+{
+  return (link & 1) != 0;
+}
+
+/**
+ * @brief Compare ids and return <0 if id1 comes first, 0 for equal and >0 if id2 comes
+ *        first, as spObjectStore does
+ *
+ * @param id1  first id
+ * @param id2  second id
+ * @return int32_t
+ */
+template <class T>
+int32_t spObjectSkipListStore<T>::compareIds(const std::string &id1, const std::string &id2)
+{
+  int32_t cmpRes = strcmp(id1.c_str(), id2.c_str());
+  if (_sorting == DESC)
+  {
+    cmpRes *= -1;
+  }
+  return cmpRes;
+}
+
+/**
+ * @brief Returns a random height with a probability of 1/4 for each additional level
+ *
+ * @return int
+ */
+template <class T>
+int spObjectSkipListStore<T>::randomHeight()
+{
+  static thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+  // xorshift64
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  uint64_t bits = state;
+  int height = 1;
+  while ((height < SPOS_SKIP_MAX_LEVEL) && ((bits & 3) == 0))
+  {
+    height++;
+    bits >>= 2;
+  }
+  return height;
+}
+
+/**
+ * @brief Find the predecessors and successors of the id on all levels, whereby marked
+ *        nodes passed are unlinked, and return whether the id is stored (as succs[0])
+ *
+ * @param id  id to find
+ * @param preds  array of SPOS_SKIP_MAX_LEVEL predecessors
+ * @param succs  array of SPOS_SKIP_MAX_LEVEL successors
+ * @return true / false
+ */
+template <class T>
+bool spObjectSkipListStore<T>::find(const std::string &id, spos_skip_node **preds, spos_skip_node **succs)
+{
+retry:
+  spos_skip_node *pred = _head;
+  for (int level = SPOS_SKIP_MAX_LEVEL - 1; level >= 0; level--)
+  {
+    spos_skip_node *curr = nodeOf(pred->next[level].load());
+    while (curr != nullptr)
+    {
+      uintptr_t link = curr->next[level].load();
+      if (isMarked(link))
+      {
+        uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+        if (!pred->next[level].compare_exchange_strong(expected, link & ~static_cast<uintptr_t>(1)))
+        {
+          goto retry;
+        }
+        curr = nodeOf(link);
+        continue;
+      }
+      if (compareIds(curr->id, id) >= 0)
+      {
+        break;
+      }
+      pred = curr;
+      curr = nodeOf(link);
+    }
+    preds[level] = pred;
+    succs[level] = curr;
+  }
+  return (succs[0] != nullptr) && (succs[0]->id == id);
+}
+
+/**
+ * @brief Unlink all marked nodes with the given id on all levels. Unlike find(), this
+ *        passes nodes with the same id, as a node added again with this id may have been
+ *        linked in front of the marked one
+ *
+ * @param id  id of the marked node
+ */
+template <class T>
+void spObjectSkipListStore<T>::unlinkMarked(const std::string &id)
+{
+retry:
+  spos_skip_node *pred = _head;
+  for (int level = SPOS_SKIP_MAX_LEVEL - 1; level >= 0; level--)
+  {
+    spos_skip_node *curr = nodeOf(pred->next[level].load());
+    while (curr != nullptr)
+    {
+      uintptr_t link = curr->next[level].load();
+      if (isMarked(link))
+      {
+        uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+        if (!pred->next[level].compare_exchange_strong(expected, link & ~static_cast<uintptr_t>(1)))
+        {
+          goto retry;
+        }
+        curr = nodeOf(link);
+        continue;
+      }
+      if (compareIds(curr->id, id) > 0)
+      {
+        break;
+      }
+      pred = curr;
+      curr = nodeOf(link);
+    }
+  }
+}
+
+/**
+ * @brief Insert a new node with the object or replace the object of an existing node
+ *        with this id. The node is linked on the lowest level first and then upwards,
+ *        whereby linking stops when the node is deleted meanwhile
+ *
+ * @param slot  the pinned slot of the calling thread
+ * @param id  id of the object
+ * @param obj  the new object, owned by the store afterwards
+ * @return true if the id was added, false if an object was replaced
+ */
+template <class T>
+bool spObjectSkipListStore<T>::insertObj(size_t slot, const std::string &id, T *obj)
+{
+  spos_skip_node *preds[SPOS_SKIP_MAX_LEVEL];
+  spos_skip_node *succs[SPOS_SKIP_MAX_LEVEL];
+  int height = randomHeight();
+  spos_skip_node *node = nullptr;
+  while (true)
+  {
+    if (find(id, preds, succs))
+    {
+      if (node != nullptr)
+      {
+        // never visible to others, the object is kept
+        node->obj.store(nullptr, std::memory_order_relaxed);
+        delete node;
+      }
+      retire(slot, nullptr, succs[0]->obj.exchange(obj));
+      return false;
+    }
+    if (node == nullptr)
+    {
+      node = new spos_skip_node(id, obj, height);
+    }
+    for (int level = 0; level < height; level++)
+    {
+      node->next[level].store(reinterpret_cast<uintptr_t>(succs[level]), std::memory_order_relaxed);
+    }
+    uintptr_t expected = reinterpret_cast<uintptr_t>(succs[0]);
+    if (preds[0]->next[0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node)))
+    {
+      break;
+    }
+  }
+  _size.fetch_add(1);
+
+  bool deleted = false;
+  for (int level = 1; (level < height) && !deleted; level++)
+  {
+    while (true)
+    {
+      uintptr_t link = node->next[level].load();
+      uintptr_t succ = reinterpret_cast<uintptr_t>(succs[level]);
+      if (isMarked(link) || ((link != succ) && !node->next[level].compare_exchange_strong(link, succ)))
+      {
+        deleted = true;
+        break;
+      }
+      uintptr_t expected = succ;
+      if (preds[level]->next[level].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node)))
+      {
+        break;
+      }
+      if (!find(id, preds, succs) || (succs[0] != node))
+      {
+        deleted = true;
+        break;
+      }
+    }
+  }
+  // a delete may have missed the levels linked after it passed them
+  if (isMarked(node->next[0].load()))
+  {
+    unlinkMarked(id);
+  }
+  return true;
+}
+
+/**
+ * @brief Take a free slot and pin the current epoch in it. The slot holds 0 while being
+ *        pinned, so that no memory is freed until its epoch is known. Every 64th call of
+ *        a thread tries to advance the epoch, so that retired memory gets freed even when
+ *        its slot is not used for a while
+ *
+ * @return size_t  the slot
+ */
+template <class T>
+size_t spObjectSkipListStore<T>::pin()
+{
+  static thread_local uint32_t pins = 0;
+  if ((++pins & 63) == 0)
+  {
+    advanceEpoch();
+  }
+  size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % _maxThreads;
+  while (true)
+  {
+    for (size_t i = 0; i < _maxThreads; i++)
+    {
+      size_t slot = (start + i) % _maxThreads;
+      uint64_t expected = UINT64_MAX;
+      if (_slots[slot].epoch.compare_exchange_strong(expected, 0))
+      {
+        _slots[slot].epoch.store(_epoch.load());
+        return slot;
+      }
+    }
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * @brief Release the slot, after freeing its retired memory once enough has piled up.
+ *        This is done unpinned, so that it does not hold back the epoch, while the
+ *        slot is still held (UINT64_MAX - 1) and its memory not used by other threads
+ *
+ * @param slot  the slot
+ */
+template <class T>
+void spObjectSkipListStore<T>::unpin(size_t slot)
+{
+  if (_slots[slot].retired.size() >= _slots[slot].collectAt)
+  {
+    _slots[slot].epoch.store(UINT64_MAX - 1);
+    collectSlot(slot);
+  }
+  _slots[slot].epoch.store(UINT64_MAX);
+}
+
+/**
+ * @brief Keep an unlinked node and / or a replaced object in the slot until no thread can
+ *        reach it anymore, see unpin()
+ *
+ * @param slot  the pinned slot of the calling thread
+ * @param node  the node or nullptr
+ * @param obj  the object or nullptr
+ */
+template <class T>
+void spObjectSkipListStore<T>::retire(size_t slot, spos_skip_node *node, T *obj)
+{
+  _slots[slot].retired.push_back({_epoch.load(), node, obj});
+}
+
+/**
+ * @brief Advance the epoch, if all pinned threads are at the current one, and return the
+ *        lowest pinned epoch (or the current one)
+ *
+ * @return uint64_t
+ */
+template <class T>
+uint64_t spObjectSkipListStore<T>::advanceEpoch()
+{
+  uint64_t epoch = _epoch.load();
+  uint64_t minEpoch = epoch;
+  for (size_t i = 0; i < _maxThreads; i++)
+  {
+    uint64_t pinned = _slots[i].epoch.load();
+    if (pinned < minEpoch)
+    {
+      minEpoch = pinned;
+    }
+  }
+  if (minEpoch == epoch)
+  {
+    _epoch.compare_exchange_strong(epoch, epoch + 1);
+  }
+  return minEpoch;
+}
+
+/**
+ * @brief Free the slot's memory retired 2 epochs before the lowest pinned epoch. A thread
+ *        pinned at the epoch of retirement may still link the node (as its inserter) and
+ *        one pinned at the next epoch may still reach it
+ *
+ * @param slot  the slot held by the calling thread
+ */
+template <class T>
+void spObjectSkipListStore<T>::collectSlot(size_t slot)
+{
+  uint64_t minEpoch = advanceEpoch();
+  std::vector<spos_skip_retired> &retired = _slots[slot].retired;
+  size_t kept = 0;
+  for (size_t i = 0; i < retired.size(); i++)
+  {
+    if (retired[i].epoch + 1 < minEpoch)
+    {
+      delete retired[i].node;
+      delete retired[i].obj;
+    }
+    else
+    {
+      retired[kept++] = retired[i];
+    }
+  }
+  retired.resize(kept);
+  // memory retired within the last 2 epochs is kept, so look again after some more
+  _slots[slot].collectAt = kept + 64;
+}
+
+
+#endif
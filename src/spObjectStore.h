@@ -2,8 +2,8 @@
  * @file spObjectStore.h
  * @author krokoreit (krokoreit@gmail.com)
  * @brief a templated container class to add, retrieve, delete and iterate through objects
- * @version 2.1.3
- * @date 2024-10-23
+ * @version 2.2.0
+ * @date 2026-10-18
  * 
  * @copyright Copyright (c) 2024
  * 
@@ -22,6 +22,33 @@
  * v2.1.1   eliminated printf() used, set version
  * v2.1.2   change over to new version
  * v2.1.3   align versioning for git
+ * v2.2.0   query and performance additions
+ *          - added topK() / bottomK() and parallel variants
+ *          - added spObjectQueue class for heap based priority queues
+ *          - added secondary indexes and queries with where() / explain()
+ *          - added columnar projections with count, sum and filter kernels
+ *          - added spatial indexes with nearest() / withinBox()
+ *          - added trigram text indexes with findContaining()
+ *          - added join(), leftJoin(), antiJoin() and joinParallel()
+ *          - added set algebra with unionWith(), intersectWith() and differenceFrom()
+ *          - added hash trees and diff()
+ *          - added change feed with setChangeCallback(), applyChanges() and spObjectChangeQueue
+ *          - re-sorting with preserved ids sorts in one pass
+ *          - added per-entry versions with forEachChangedSince() and tombstones
+ *          - added batches with beginBatch(), commit() and rollback()
+ *          - added spObjectMVCCStore class for multi-version concurrency control
+ *          - added spObjectSkipListStore class based on a lock-free skip list
+ *          - added spObjectSeqLockStore class with optimistic seqlock reads
+ *          - added spObjectHashStore class based on a lock-striped hash table
+ *          - added spObjectBufferedStore class with per-thread write buffers merged in the background
+ *          - added write buffer for sorted stores with setWriteBuffer() and mergeWriteBuffer()
+ *          - added lazy sorting with setLazySorting()
+ *          - added deferred deletes with setDeferredDeletes() and compactDeleted()
+ *          - added spObjectGapStore class with a gap buffer for clustered inserts
+ *          - added addObjWithIdHint() for adding sorted ids with a position hint
+ *          - added extract(), insert() and rekey() for moving entries without copying objects
+ *          - objects may be move-only and are moved instead of copied when reorganizing entries
+ *          - added spliceFrom(), splitAt() and mergeFrom() for moving entries between stores
  *   
  */
 
@@ -35,6 +62,18 @@
 #include <string.h>
 #include <functional>
 #include <vector>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <type_traits>
+#include <new>
+#include <unordered_map>
+#include <iterator>
+#include <unordered_set>
+#include <atomic>
+#if __cplusplus >= 201703L
+#include <optional>
+#endif
 
 
 /**
@@ -63,867 +102,5878 @@ enum sposSort
 
 
 /**
- * @brief the object storage class
- * @tparam T  class typename of objects to store
+ * @brief enum for the comparison operators used in queries
+ */
+enum sposOp
+{
+  Equal,
+  NotEqual,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual
+};
+
+
+/**
+ * @brief Returns an address unique for type U, used to identify the type of an index
+ *        without the need for RTTI
+ */
+template <class U>
+const void* spos_type_tag()
+{
+  static const char tag = 0;
+  return &tag;
+}
+
+
+/**
+ * @brief Holds U in a non-deduced context, so that U is not deduced from an argument 
+ *        but has to be given explicitly
+ */
+template <class U>
+struct spos_non_deduced
+{
+  typedef U type;
+};
+
+
+/**
+ * @brief Splits the type M of a pointer to a data member into the class and the type of 
+ *        the member. Functions taking member pointers take them as M, because U T::* in 
+ *        a declaration would not compile for stores of non-class types
+ */
+template <class M>
+struct spos_member_traits
+{
+};
+template <class C, class U>
+struct spos_member_traits<U C::*>
+{
+  typedef C class_type;
+  typedef U value_type;
+};
+
+
+/**
+ * @brief base class for secondary structures, which are kept in sync with the entries 
+ *        of a store and refer to these entries by their position in the store
+ * @tparam T  class typename of objects stored
  */
 template <class T>
-class spObjectStore
+class spos_index
 {
-   public:
-    /*  typedef for comparison function
-        int myCmpFunc(const T &obj_A, const T &obj_B);
-        return value: <0 = A has lower value, 0 = same, >0 = A has higher value   */
-    typedef std::function<int(const T&, const T&)> spos_compare_callback;
-    /*  typedef for id creating function
-        std::string myCreateIdFunc(const T &obj);  */
-    typedef std::function<std::string(const T&)> spos_create_id_callback;
-    /*  typedef for interation function, object only
-        std::string myIterateFunc(const T &obj);  */
-    typedef std::function<bool(const T&)> spos_forEach_O_callback;
-    /*  typedef for interation function, id and object
-        std::string myIterateFunc(const std::string &id, const T &obj);  */
-    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+  public:
+    std::string _name;
+    const void* _typeTag = nullptr;
 
-   private:
-    std::vector<std::string> _ids;
-    std::vector<T> _objects;
-    int32_t _index = -1;
-    size_t _capaInc = 10;
-    spos_compare_callback _compareCB;
-    bool _added = false;
-    sposSort _sorting = None;
-    std::string _idSep = "#/#";
-    uint32_t _autoId = 10000;
-    uint8_t _idNumDigits = 8;
-    uint8_t _idNumDecimals = 6;
-    uint8_t _idNumSize = 16;
-    spos_create_id_callback _createIdCB;
+    virtual ~spos_index() {}
+    virtual spos_index<T>* clone() const = 0;
+    // entry inserted at pos, entries from pos onwards moved up by one
+    virtual void onInsert(size_t pos, const std::string &id, const T &obj) = 0;
+    // entry at pos about to be erased, entries after pos will move down by one
+    virtual void onErase(size_t pos, const std::string &id, const T &obj) = 0;
+    // object at pos replaced or changed
+    virtual void onReplace(size_t pos, const std::string &id, const T &obj) = 0;
+    // all entries removed
+    virtual void onReset() = 0;
+    // all entries (re)built at once
+    virtual void onRebuild(const std::vector<std::string> &ids, const std::vector<T> &objects)
+    {
+      onReset();
+      for (size_t i = 0; i < ids.size(); i++)
+      {
+        onInsert(i, ids[i], objects[i]);
+      }
+    }
+};
 
-    int32_t compareIds(const std::string &id1, const std::string &id2);
-    int32_t indexOf(const std::string &id, T *obj);
-    void setCapacity(size_t capacity);
-    void setAdded(bool added);
-    std::string stringify(const uint64_t &value);
-    std::string stringify(const uint32_t &value);
-    std::string stringify(const uint16_t &value);
-    std::string stringify(const uint8_t &value);
-    std::string stringify(const int64_t &value);
-    std::string stringify(const int32_t &value);
-    std::string stringify(const int16_t &value);
-    std::string stringify(const int8_t &value);
-    std::string stringify(const long double &value);
-    std::string stringify(const double &value);
-    std::string stringify(const float &value);
-    std::string stringify(const std::string &value);
-    std::string stringify(const char &value);
-    std::string makeIdFrom();
-    template<class U>
-    std::string makeIdFrom(U arg);
-    template<class U, class... Vs>
-    std::string makeIdFrom(U arg, Vs... args);
-    std::string createId(const T &obj);
-    void recreate(bool preserveIds);
 
-   public:
-    spObjectStore();
-    spObjectStore(sposSort sorting);
-    spObjectStore(spos_compare_callback callback);
-    template <class... Vs>
-    T* addObjWithId(const std::string &id, Vs... args);
-    template <class... Vs>
-    T* addObjFromArgs(Vs... args);
-    T* setObjWithId(const std::string &id, T &newObj);
-    T* getObjById(const std::string &id);
-    template <class... Vs>
-    T* getObjFromArgs(Vs... args);
-    template <class... Vs>
-    std::string getIdFromArgs(Vs... args);
-    bool deleteObjById(const std::string &id);
-    template <class... Vs>
-    bool deleteObjFromArgs(Vs... args);
-    void reset();
-    void forEach(spos_forEach_O_callback callback);
-    void forEach(spos_forEach_IO_callback callback);
-    size_t getCapacityInc();
-    void setCapacityInc(size_t newInc);
-    size_t getSize();
-    bool isAdded();
-    bool isSorted();
-    sposSort getSorting();
-    void setSorting(sposSort sorting);
-    std::string getIdSeparator();
-    void setIdSeparator(std::string separator);
-    uint8_t getIdNumDecimals();
-    void setIdNumDecimals(uint8_t decimals);
-    uint8_t getIdNumDigits();
-    void setIdNumDigits(uint8_t digits);
-    template <class... Vs>
-    std::string makeIdFromArgs(Vs... args);
-    void setCreateIdCallback(spos_create_id_callback callback);
-    void setCompareCallback(spos_compare_callback callback);
+/**
+ * @brief secondary index keeping the positions of entries sorted by the value of 
+ *        one of the object's members
+ * @tparam T  class typename of objects stored
+ * @tparam U  type of the member
+ */
+template <class T, class U>
+class spos_sorted_index : public spos_index<T>
+{
+  public:
+    typedef std::pair<U, size_t> spos_index_entry;
+    U T::*_member;
+    std::vector<spos_index_entry> _entries;
+
+    spos_sorted_index(const std::string &name, U T::*member)
+    {
+      this->_name = name;
+      this->_typeTag = spos_type_tag<spos_sorted_index<T, U>>();
+      _member = member;
+    }
+
+    spos_index<T>* clone() const override
+    {
+      return new spos_sorted_index<T, U>(*this);
+    }
+
+    void onInsert(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      shift(pos, 1);
+      auto it = std::upper_bound(_entries.begin(), _entries.end(), obj.*_member, 
+                                 [](const U &value, const spos_index_entry &entry) { return value < entry.first; });
+      _entries.insert(it, spos_index_entry(obj.*_member, pos));
+    }
+
+    void onErase(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      _entries.erase(_entries.begin() + find(pos, obj.*_member));
+      shift(pos + 1, -1);
+    }
+
+    void onReplace(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      // the old value is gone, so look for the position itself
+      for (size_t i = 0; i < _entries.size(); i++)
+      {
+        if (_entries[i].second == pos)
+        {
+          _entries.erase(_entries.begin() + i);
+          break;
+        }
+      }
+      auto it = std::upper_bound(_entries.begin(), _entries.end(), obj.*_member, 
+                                 [](const U &value, const spos_index_entry &entry) { return value < entry.first; });
+      _entries.insert(it, spos_index_entry(obj.*_member, pos));
+    }
+
+    void onReset() override
+    {
+      _entries.clear();
+    }
+
+    void onRebuild(const std::vector<std::string> & /* ids */, const std::vector<T> &objects) override
+    {
+      _entries.clear();
+      _entries.reserve(objects.size());
+      for (size_t i = 0; i < objects.size(); i++)
+      {
+        _entries.push_back(spos_index_entry(objects[i].*_member, i));
+      }
+      std::stable_sort(_entries.begin(), _entries.end(), 
+                       [](const spos_index_entry &a, const spos_index_entry &b) { return a.first < b.first; });
+    }
+
+    // get the range [first, last) of _entries matching op and value, false if op is not supported
+    bool range(sposOp op, const U &value, size_t &first, size_t &last)
+    {
+      size_t lower = std::lower_bound(_entries.begin(), _entries.end(), value, 
+                                      [](const spos_index_entry &entry, const U &v) { return entry.first < v; }) - _entries.begin();
+      size_t upper = std::upper_bound(_entries.begin() + lower, _entries.end(), value, 
+                                      [](const U &v, const spos_index_entry &entry) { return v < entry.first; }) - _entries.begin();
+      switch (op)
+      {
+        case Equal:         first = lower; last = upper; break;
+        case Less:          first = 0; last = lower; break;
+        case LessEqual:     first = 0; last = upper; break;
+        case Greater:       first = upper; last = _entries.size(); break;
+        case GreaterEqual:  first = lower; last = _entries.size(); break;
+        default:            return false;
+      }
+      return true;
+    }
+
+  private:
+    // move positions from pos onwards by delta
+    void shift(size_t pos, int delta)
+    {
+      for (size_t i = 0; i < _entries.size(); i++)
+      {
+        if (_entries[i].second >= pos)
+        {
+          _entries[i].second += delta;
+        }
+      }
+    }
+
+    // index into _entries for position pos, searching the entries with value first
+    size_t find(size_t pos, const U &value)
+    {
+      auto it = std::lower_bound(_entries.begin(), _entries.end(), value, 
+                                 [](const spos_index_entry &entry, const U &v) { return entry.first < v; });
+      for (; (it != _entries.end()) && !(value < it->first); it++)
+      {
+        if (it->second == pos)
+        {
+          return it - _entries.begin();
+        }
+      }
+      // object was changed without touchObjById(), do it the hard way
+      for (size_t i = 0; i < _entries.size(); i++)
+      {
+        if (_entries[i].second == pos)
+        {
+          return i;
+        }
+      }
+      return 0;
+    }
 };
 
 
-/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC    
+/**
+ * @brief allocator returning memory aligned to A bytes, used for projection columns
+ * @tparam U  type of the elements
+ * @tparam A  alignment in bytes
+ */
+template <class U, size_t A = 64>
+struct spos_aligned_allocator
+{
+  typedef U value_type;
+  template <class V>
+  struct rebind
+  {
+    typedef spos_aligned_allocator<V, A> other;
+  };
 
-      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx 
-      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
-      xx    xx  xx    xx  xx    xx  xx           xx     xx      
-      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx      
-      xx        xx    xx  xx    xx  xx           xx     xx      
-      xx        xx    xx  xx    xx  xx           xx     xx    xx
-      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx 
-     
+  spos_aligned_allocator() {}
+  template <class V>
+  spos_aligned_allocator(const spos_aligned_allocator<V, A> & /* other */) {}
 
-      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+  U* allocate(size_t n)
+  {
+    // over-allocate, align by hand and keep the raw pointer in front of the data
+    void *raw = ::operator new(n * sizeof(U) + A + sizeof(void*));
+    uintptr_t data = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + A - 1) & ~uintptr_t(A - 1);
+    reinterpret_cast<void**>(data)[-1] = raw;
+    return reinterpret_cast<U*>(data);
+  }
+  void deallocate(U *p, size_t /* n */)
+  {
+    ::operator delete(reinterpret_cast<void**>(p)[-1]);
+  }
+  template <class V>
+  bool operator==(const spos_aligned_allocator<V, A> & /* other */) const { return true; }
+  template <class V>
+  bool operator!=(const spos_aligned_allocator<V, A> & /* other */) const { return false; }
+};
+
+
+/**
+ * @brief projection keeping the value of one of the object's members in a contiguous 
+ *        column parallel to the store's entries, so that scans over this member do not
+ *        need to touch the objects. The kernels are plain loops over the column, which
+ *        the compiler can vectorize
+ * @tparam T  class typename of objects stored
+ * @tparam U  type of the member, an arithmetic type
+ */
+template <class T, class U>
+class spos_projection : public spos_index<T>
+{
+  public:
+    typedef typename std::conditional<std::is_floating_point<U>::value, double, 
+            typename std::conditional<std::is_signed<U>::value, int64_t, uint64_t>::type>::type spos_sum_type;
+    U T::*_member;
+    std::vector<U, spos_aligned_allocator<U>> _column;
+
+    spos_projection(const std::string &name, U T::*member)
+    {
+      static_assert(std::is_arithmetic<U>::value, "projections need an arithmetic member");
+      this->_name = name;
+      this->_typeTag = spos_type_tag<spos_projection<T, U>>();
+      _member = member;
+    }
+
+    spos_index<T>* clone() const override
+    {
+      return new spos_projection<T, U>(*this);
+    }
+
+    void onInsert(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      _column.insert(_column.begin() + pos, obj.*_member);
+    }
+
+    void onErase(size_t pos, const std::string & /* id */, const T & /* obj */) override
+    {
+      _column.erase(_column.begin() + pos);
+    }
+
+    void onReplace(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      _column[pos] = obj.*_member;
+    }
+
+    void onReset() override
+    {
+      _column.clear();
+    }
+
+    void onRebuild(const std::vector<std::string> & /* ids */, const std::vector<T> &objects) override
+    {
+      _column.resize(objects.size());
+      for (size_t i = 0; i < objects.size(); i++)
+      {
+        _column[i] = objects[i].*_member;
+      }
+    }
+
+    // number of values matching op and value
+    size_t count(sposOp op, const U &value) const
+    {
+      return dispatch<size_t>(op, spos_count_kernel(_column.data(), _column.size(), value));
+    }
+
+    // sum of values matching op and value, all values when op is not given
+    spos_sum_type sum() const
+    {
+      const U *data = _column.data();
+      size_t n = _column.size();
+      spos_sum_type total = 0;
+      for (size_t i = 0; i < n; i++)
+      {
+        total += data[i];
+      }
+      return total;
+    }
+    spos_sum_type sum(sposOp op, const U &value) const
+    {
+      return dispatch<spos_sum_type>(op, spos_sum_kernel(_column.data(), _column.size(), value));
+    }
+
+    // append the positions of values matching op and value
+    void filter(sposOp op, const U &value, std::vector<size_t> &positions) const
+    {
+      dispatch<size_t>(op, spos_filter_kernel(_column.data(), _column.size(), value, positions));
+    }
+
+  private:
+    // the kernels are called with the comparison functor for op by dispatch()
+    struct spos_count_kernel
+    {
+      const U *data;
+      size_t n;
+      const U &value;
+      spos_count_kernel(const U *d, size_t c, const U &v) : data(d), n(c), value(v) {}
+      template <class C>
+      size_t operator()(C cmp) const
+      {
+        size_t matches = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+          matches += cmp(data[i], value) ? 1 : 0;
+        }
+        return matches;
+      }
+    };
+
+    struct spos_sum_kernel
+    {
+      const U *data;
+      size_t n;
+      const U &value;
+      spos_sum_kernel(const U *d, size_t c, const U &v) : data(d), n(c), value(v) {}
+      template <class C>
+      spos_sum_type operator()(C cmp) const
+      {
+        spos_sum_type total = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+          total += cmp(data[i], value) ? static_cast<spos_sum_type>(data[i]) : 0;
+        }
+        return total;
+      }
+    };
+
+    struct spos_filter_kernel
+    {
+      const U *data;
+      size_t n;
+      const U &value;
+      std::vector<size_t> &positions;
+      spos_filter_kernel(const U *d, size_t c, const U &v, std::vector<size_t> &p) : data(d), n(c), value(v), positions(p) {}
+      template <class C>
+      size_t operator()(C cmp) const
+      {
+        const size_t blockSize = 256;
+        uint8_t flags[blockSize];
+        for (size_t first = 0; first < n; first += blockSize)
+        {
+          size_t count = std::min(blockSize, n - first);
+          // flags first, which vectorizes, then compact the block
+          for (size_t i = 0; i < count; i++)
+          {
+            flags[i] = cmp(data[first + i], value) ? 1 : 0;
+          }
+          for (size_t i = 0; i < count; i++)
+          {
+            if (flags[i])
+            {
+              positions.push_back(first + i);
+            }
+          }
+        }
+        return 0;
+      }
+    };
 
+    // call kernel with the comparison functor for op
+    template <class R, class K>
+    static R dispatch(sposOp op, const K &kernel)
+    {
+      switch (op)
+      {
+        case Equal:         return kernel(std::equal_to<U>());
+        case NotEqual:      return kernel(std::not_equal_to<U>());
+        case Less:          return kernel(std::less<U>());
+        case LessEqual:     return kernel(std::less_equal<U>());
+        case Greater:       return kernel(std::greater<U>());
+        default:            return kernel(std::greater_equal<U>());
+      }
+    }
+};
+
+
+/**
+ * @brief a point as used by spatial indexes
+ */
+struct sposPoint
+{
+  double lat;
+  double lon;
+};
+
+
+/**
+ * @brief spatial index over a point (lat, lon) derived from each object. Entries are kept
+ *        in a k-d tree, which is rebuilt in one pass after a number of changes, with the 
+ *        entries added or changed since then in a small list of pending ones
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spos_spatial_index : public spos_index<T>
+{
+  public:
+    typedef std::function<sposPoint(const T&)> spos_point_callback;
+    struct spos_spatial_entry
+    {
+      sposPoint point;
+      size_t pos;
+      bool deleted;
+    };
+    spos_point_callback _pointCB;
+    std::vector<spos_spatial_entry> _tree;
+    std::vector<spos_spatial_entry> _pending;
+    size_t _deletedCount = 0;
+
+    spos_spatial_index(const std::string &name, spos_point_callback callback)
+    {
+      this->_name = name;
+      this->_typeTag = spos_type_tag<spos_spatial_index<T>>();
+      _pointCB = callback;
+    }
+
+    spos_index<T>* clone() const override
+    {
+      return new spos_spatial_index<T>(*this);
+    }
+
+    void onInsert(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      shift(pos, 1);
+      _pending.push_back(spos_spatial_entry{_pointCB(obj), pos, false});
+      checkRebuild();
+    }
+
+    void onErase(size_t pos, const std::string & /* id */, const T & /* obj */) override
+    {
+      remove(pos);
+      shift(pos + 1, -1);
+      checkRebuild();
+    }
+
+    void onReplace(size_t pos, const std::string & /* id */, const T &obj) override
+    {
+      remove(pos);
+      _pending.push_back(spos_spatial_entry{_pointCB(obj), pos, false});
+      checkRebuild();
+    }
+
+    void onReset() override
+    {
+      _tree.clear();
+      _pending.clear();
+      _deletedCount = 0;
+    }
+
+    void onRebuild(const std::vector<std::string> & /* ids */, const std::vector<T> &objects) override
+    {
+      onReset();
+      _tree.reserve(objects.size());
+      for (size_t i = 0; i < objects.size(); i++)
+      {
+        _tree.push_back(spos_spatial_entry{_pointCB(objects[i]), i, false});
+      }
+      build(0, _tree.size(), 0);
+    }
+
+    // positions and squared distances of the k entries nearest to point, nearest first
+    void nearest(size_t k, const sposPoint &point, std::vector<std::pair<double, size_t>> &found)
+    {
+      found.clear();
+      if (k == 0)
+      {
+        return;
+      }
+      auto farther = [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) { return a < b; };
+      for (size_t i = 0; i < _pending.size(); i++)
+      {
+        if (!_pending[i].deleted)
+        {
+          offer(k, distance2(_pending[i].point, point), _pending[i].pos, found, farther);
+        }
+      }
+      searchNearest(0, _tree.size(), 0, k, point, found);
+      std::sort_heap(found.begin(), found.end(), farther);
+    }
+
+    // positions of entries within the box, in no specific order
+    void withinBox(const sposPoint &minPoint, const sposPoint &maxPoint, std::vector<size_t> &positions)
+    {
+      for (size_t i = 0; i < _pending.size(); i++)
+      {
+        if (!_pending[i].deleted && inBox(_pending[i].point, minPoint, maxPoint))
+        {
+          positions.push_back(_pending[i].pos);
+        }
+      }
+      searchBox(0, _tree.size(), 0, minPoint, maxPoint, positions);
+    }
+
+  private:
+    static double coord(const sposPoint &point, size_t depth)
+    {
+      return (depth % 2 == 0) ? point.lat : point.lon;
+    }
+
+    static double distance2(const sposPoint &a, const sposPoint &b)
+    {
+      double dLat = a.lat - b.lat;
+      double dLon = a.lon - b.lon;
+      return dLat * dLat + dLon * dLon;
+    }
+
+    static bool inBox(const sposPoint &point, const sposPoint &minPoint, const sposPoint &maxPoint)
+    {
+      return (point.lat >= minPoint.lat) && (point.lat <= maxPoint.lat) && 
+             (point.lon >= minPoint.lon) && (point.lon <= maxPoint.lon);
+    }
+
+    // keep the k nearest in a heap with the farthest on top
+    template <class F>
+    static void offer(size_t k, double dist2, size_t pos, std::vector<std::pair<double, size_t>> &found, F farther)
+    {
+      if (found.size() < k)
+      {
+        found.push_back(std::make_pair(dist2, pos));
+        std::push_heap(found.begin(), found.end(), farther);
+      }
+      else if (std::make_pair(dist2, pos) < found.front())
+      {
+        std::pop_heap(found.begin(), found.end(), farther);
+        found.back() = std::make_pair(dist2, pos);
+        std::push_heap(found.begin(), found.end(), farther);
+      }
+    }
+
+    // k-d tree over [first, last) with the median at the middle
+    void build(size_t first, size_t last, size_t depth)
+    {
+      if (last - first < 2)
+      {
+        return;
+      }
+      size_t mid = first + (last - first) / 2;
+      std::nth_element(_tree.begin() + first, _tree.begin() + mid, _tree.begin() + last,
+                       [depth](const spos_spatial_entry &a, const spos_spatial_entry &b) { return coord(a.point, depth) < coord(b.point, depth); });
+      build(first, mid, depth + 1);
+      build(mid + 1, last, depth + 1);
+    }
+
+    void searchNearest(size_t first, size_t last, size_t depth, size_t k, const sposPoint &point, std::vector<std::pair<double, size_t>> &found)
+    {
+      if (first >= last)
+      {
+        return;
+      }
+      size_t mid = first + (last - first) / 2;
+      const spos_spatial_entry &entry = _tree[mid];
+      auto farther = [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) { return a < b; };
+      if (!entry.deleted)
+      {
+        offer(k, distance2(entry.point, point), entry.pos, found, farther);
+      }
+      double diff = coord(point, depth) - coord(entry.point, depth);
+      bool lowerFirst = (diff < 0);
+      if (lowerFirst)
+      {
+        searchNearest(first, mid, depth + 1, k, point, found);
+      }
+      else
+      {
+        searchNearest(mid + 1, last, depth + 1, k, point, found);
+      }
+      // other side only if it can hold something nearer
+      if ((found.size() < k) || (diff * diff <= found.front().first))
+      {
+        if (lowerFirst)
+        {
+          searchNearest(mid + 1, last, depth + 1, k, point, found);
+        }
+        else
+        {
+          searchNearest(first, mid, depth + 1, k, point, found);
+        }
+      }
+    }
+
+    void searchBox(size_t first, size_t last, size_t depth, const sposPoint &minPoint, const sposPoint &maxPoint, std::vector<size_t> &positions)
+    {
+      if (first >= last)
+      {
+        return;
+      }
+      size_t mid = first + (last - first) / 2;
+      const spos_spatial_entry &entry = _tree[mid];
+      if (!entry.deleted && inBox(entry.point, minPoint, maxPoint))
+      {
+        positions.push_back(entry.pos);
+      }
+      double value = coord(entry.point, depth);
+      if (coord(minPoint, depth) <= value)
+      {
+        searchBox(first, mid, depth + 1, minPoint, maxPoint, positions);
+      }
+      if (coord(maxPoint, depth) >= value)
+      {
+        searchBox(mid + 1, last, depth + 1, minPoint, maxPoint, positions);
+      }
+    }
+
+    // move positions from pos onwards by delta
+    void shift(size_t pos, int delta)
+    {
+      for (size_t i = 0; i < _tree.size(); i++)
+      {
+        if (_tree[i].pos >= pos)
+        {
+          _tree[i].pos += delta;
+        }
+      }
+      for (size_t i = 0; i < _pending.size(); i++)
+      {
+        if (_pending[i].pos >= pos)
+        {
+          _pending[i].pos += delta;
+        }
+      }
+    }
+
+    // mark the entry for pos as deleted
+    void remove(size_t pos)
+    {
+      for (size_t i = 0; i < _pending.size(); i++)
+      {
+        if (!_pending[i].deleted && (_pending[i].pos == pos))
+        {
+          _pending.erase(_pending.begin() + i);
+          return;
+        }
+      }
+      for (size_t i = 0; i < _tree.size(); i++)
+      {
+        if (!_tree[i].deleted && (_tree[i].pos == pos))
+        {
+          _tree[i].deleted = true;
+          _deletedCount++;
+          return;
+        }
+      }
+    }
+
+    // rebuild the tree, when pending and deleted entries exceed ~ 4 * sqrt(n)
+    void checkRebuild()
+    {
+      size_t changes = _pending.size() + _deletedCount;
+      size_t limit = 64;
+      while (limit * limit < 16 * _tree.size())
+      {
+        limit *= 2;
+      }
+      if (changes <= limit)
+      {
+        return;
+      }
+      std::vector<spos_spatial_entry> entries;
+      entries.reserve(_tree.size() - _deletedCount + _pending.size());
+      for (size_t i = 0; i < _tree.size(); i++)
+      {
+        if (!_tree[i].deleted)
+        {
+          entries.push_back(_tree[i]);
+        }
+      }
+      entries.insert(entries.end(), _pending.begin(), _pending.end());
+      _tree.swap(entries);
+      _pending.clear();
+      _deletedCount = 0;
+      build(0, _tree.size(), 0);
+    }
+};
+
+
+/**
+ * @brief trigram index over the ids or a text derived from each object, used to find 
+ *        entries containing a fragment. Each entry gets a document number on insert and
+ *        each trigram a posting list of document numbers, compressed as varint encoded 
+ *        deltas. Deleted documents are skipped until the index is compacted
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spos_text_index : public spos_index<T>
+{
+  public:
+    typedef std::function<std::string(const T&)> spos_text_callback;
+    struct spos_posting_list
+    {
+      std::vector<uint8_t> data;
+      uint32_t last = 0;
+      uint32_t count = 0;
+    };
+    static const size_t npos = SIZE_MAX;
+    spos_text_callback _textCB;
+    std::unordered_map<uint32_t, spos_posting_list> _postings;
+    std::vector<uint32_t> _docOfPos;
+    std::vector<size_t> _posOfDoc;
+    size_t _deletedDocs = 0;
+
+    spos_text_index(const std::string &name, spos_text_callback callback)
+    {
+      this->_name = name;
+      this->_typeTag = spos_type_tag<spos_text_index<T>>();
+      _textCB = callback;
+    }
+
+    spos_index<T>* clone() const override
+    {
+      return new spos_text_index<T>(*this);
+    }
+
+    void onInsert(size_t pos, const std::string &id, const T &obj) override
+    {
+      uint32_t doc = addDoc(text(id, obj), pos);
+      _docOfPos.insert(_docOfPos.begin() + pos, doc);
+      for (size_t i = pos + 1; i < _docOfPos.size(); i++)
+      {
+        _posOfDoc[_docOfPos[i]] = i;
+      }
+    }
+
+    void onErase(size_t pos, const std::string & /* id */, const T & /* obj */) override
+    {
+      _posOfDoc[_docOfPos[pos]] = npos;
+      _deletedDocs++;
+      _docOfPos.erase(_docOfPos.begin() + pos);
+      for (size_t i = pos; i < _docOfPos.size(); i++)
+      {
+        _posOfDoc[_docOfPos[i]] = i;
+      }
+      compactIfNeeded();
+    }
+
+    void onReplace(size_t pos, const std::string &id, const T &obj) override
+    {
+      // ids do not change when replacing objects
+      if (_textCB == nullptr)
+      {
+        return;
+      }
+      _posOfDoc[_docOfPos[pos]] = npos;
+      _deletedDocs++;
+      _docOfPos[pos] = addDoc(text(id, obj), pos);
+      compactIfNeeded();
+    }
+
+    void onReset() override
+    {
+      _postings.clear();
+      _docOfPos.clear();
+      _posOfDoc.clear();
+      _deletedDocs = 0;
+    }
+
+    void onRebuild(const std::vector<std::string> &ids, const std::vector<T> &objects) override
+    {
+      onReset();
+      _docOfPos.reserve(ids.size());
+      _posOfDoc.reserve(ids.size());
+      for (size_t i = 0; i < ids.size(); i++)
+      {
+        _docOfPos.push_back(addDoc(text(ids[i], objects[i]), i));
+      }
+    }
+
+    // positions of entries containing fragment, in store order
+    void find(const std::string &fragment, const std::vector<std::string> &ids, const std::vector<T> &objects, std::vector<size_t> &positions)
+    {
+      if (fragment.length() < 3)
+      {
+        // no trigram to look for, check all
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+          if (text(ids[i], objects[i]).find(fragment) != std::string::npos)
+          {
+            positions.push_back(i);
+          }
+        }
+        return;
+      }
+
+      // posting lists of the fragment's trigrams, shortest first
+      std::vector<uint32_t> grams;
+      trigrams(fragment, grams);
+      std::vector<const spos_posting_list*> lists;
+      for (size_t i = 0; i < grams.size(); i++)
+      {
+        auto it = _postings.find(grams[i]);
+        if (it == _postings.end())
+        {
+          return;
+        }
+        lists.push_back(&it->second);
+      }
+      std::sort(lists.begin(), lists.end(), 
+                [](const spos_posting_list *a, const spos_posting_list *b) { return a->count < b->count; });
+
+      // intersect and verify the candidates
+      std::vector<uint32_t> docs;
+      std::vector<uint32_t> other;
+      std::vector<uint32_t> common;
+      decode(*lists[0], docs);
+      for (size_t i = 1; (i < lists.size()) && (docs.size() > 0); i++)
+      {
+        decode(*lists[i], other);
+        common.clear();
+        std::set_intersection(docs.begin(), docs.end(), other.begin(), other.end(), std::back_inserter(common));
+        docs.swap(common);
+      }
+      for (size_t i = 0; i < docs.size(); i++)
+      {
+        size_t pos = _posOfDoc[docs[i]];
+        if ((pos != npos) && (text(ids[pos], objects[pos]).find(fragment) != std::string::npos))
+        {
+          positions.push_back(pos);
+        }
+      }
+      std::sort(positions.begin(), positions.end());
+    }
+
+  private:
+    std::string text(const std::string &id, const T &obj)
+    {
+      return (_textCB == nullptr) ? id : _textCB(obj);
+    }
+
+    static void trigrams(const std::string &text, std::vector<uint32_t> &grams)
+    {
+      grams.clear();
+      for (size_t i = 0; i + 3 <= text.length(); i++)
+      {
+        grams.push_back((uint32_t(uint8_t(text[i])) << 16) | (uint32_t(uint8_t(text[i + 1])) << 8) | uint32_t(uint8_t(text[i + 2])));
+      }
+      std::sort(grams.begin(), grams.end());
+      grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    }
+
+    // add a document with a new number, which is higher than all others
+    uint32_t addDoc(const std::string &text, size_t pos)
+    {
+      uint32_t doc = _posOfDoc.size();
+      _posOfDoc.push_back(pos);
+      std::vector<uint32_t> grams;
+      trigrams(text, grams);
+      for (size_t i = 0; i < grams.size(); i++)
+      {
+        append(_postings[grams[i]], doc);
+      }
+      return doc;
+    }
+
+    // compact when more than half of the documents are deleted
+    void compactIfNeeded()
+    {
+      if ((_deletedDocs > 64) && (_deletedDocs > _posOfDoc.size() / 2))
+      {
+        compact();
+      }
+    }
+
+    // drop the deleted documents from the posting lists and renumber the others in 
+    // their current order, which keeps the posting lists sorted
+    void compact()
+    {
+      std::vector<uint32_t> newDoc(_posOfDoc.size(), UINT32_MAX);
+      std::vector<size_t> posOfDoc;
+      posOfDoc.reserve(_posOfDoc.size() - _deletedDocs);
+      for (size_t doc = 0; doc < _posOfDoc.size(); doc++)
+      {
+        if (_posOfDoc[doc] != npos)
+        {
+          newDoc[doc] = posOfDoc.size();
+          posOfDoc.push_back(_posOfDoc[doc]);
+        }
+      }
+      for (size_t i = 0; i < _docOfPos.size(); i++)
+      {
+        _docOfPos[i] = newDoc[_docOfPos[i]];
+      }
+      std::vector<uint32_t> docs;
+      for (auto it = _postings.begin(); it != _postings.end(); )
+      {
+        decode(it->second, docs);
+        spos_posting_list list;
+        for (size_t i = 0; i < docs.size(); i++)
+        {
+          if (newDoc[docs[i]] != UINT32_MAX)
+          {
+            append(list, newDoc[docs[i]]);
+          }
+        }
+        if (list.count == 0)
+        {
+          it = _postings.erase(it);
+        }
+        else
+        {
+          it->second = std::move(list);
+          it++;
+        }
+      }
+      _posOfDoc.swap(posOfDoc);
+      _deletedDocs = 0;
+    }
+
+    // append doc, which is higher than all docs in list, as varint encoded delta
+    static void append(spos_posting_list &list, uint32_t doc)
+    {
+      uint32_t delta = (list.count == 0) ? doc : doc - list.last;
+      while (delta >= 0x80)
+      {
+        list.data.push_back(uint8_t(delta) | 0x80);
+        delta >>= 7;
+      }
+      list.data.push_back(uint8_t(delta));
+      list.last = doc;
+      list.count++;
+    }
+
+    static void decode(const spos_posting_list &list, std::vector<uint32_t> &docs)
+    {
+      docs.clear();
+      docs.reserve(list.count);
+      uint32_t doc = 0;
+      size_t i = 0;
+      while (i < list.data.size())
+      {
+        uint32_t delta = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+        do
+        {
+          byte = list.data[i++];
+          delta |= uint32_t(byte & 0x7F) << shift;
+          shift += 7;
+        } while (byte & 0x80);
+        doc = (docs.size() == 0) ? delta : doc + delta;
+        docs.push_back(doc);
+      }
+    }
+};
+
+
+/**
+ * @brief callback types for joining a store of T with a store of U
+ * @tparam T  class typename of objects in the first store
+ * @tparam U  class typename of objects in the second store
+ */
+template <class T, class U>
+struct spos_join_types
+{
+  /*  typedef for join function, id and objects of both stores
+      bool myJoinFunc(const std::string &id, const T &obj, const U &otherObj);  */
+  typedef std::function<bool(const std::string&, const T&, const U&)> spos_join_callback;
+  /*  typedef for left join function, id and objects of both stores, with nullptr if missing
+      bool myLeftJoinFunc(const std::string &id, const T &obj, const U *otherObj);  */
+  typedef std::function<bool(const std::string&, const T&, const U*)> spos_left_join_callback;
+};
+
+
+/**
+ * @brief hash tree over the entries, with the leaves being ranges of id hashes and each 
+ *        node holding the sum of the hashes below. An entry's hash combines its id with 
+ *        a hash of its object, so that two trees of the same depth can be compared top 
+ *        down, descending only into ranges with differing sums
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spos_hash_tree : public spos_index<T>
+{
+  public:
+    typedef std::function<uint64_t(const T&)> spos_hash_callback;
+    typedef std::pair<std::string, uint64_t> spos_leaf_entry;
+    spos_hash_callback _hashCB;
+    uint8_t _depth;
+    std::vector<uint64_t> _nodes;
+    std::vector<std::vector<spos_leaf_entry>> _leaves;
+
+    spos_hash_tree(const std::string &name, spos_hash_callback callback, uint8_t depth)
+    {
+      this->_name = name;
+      this->_typeTag = spos_type_tag<spos_hash_tree<T>>();
+      _hashCB = callback;
+      _depth = depth;
+      onReset();
+    }
+
+    spos_index<T>* clone() const override
+    {
+      return new spos_hash_tree<T>(*this);
+    }
+
+    void onInsert(size_t /* pos */, const std::string &id, const T &obj) override
+    {
+      uint64_t idHash = hashId(id);
+      uint64_t hash = entryHash(idHash, obj);
+      size_t leaf = leafOf(idHash);
+      _leaves[leaf].push_back(spos_leaf_entry(id, hash));
+      update(leaf, hash, 0);
+    }
+
+    void onErase(size_t /* pos */, const std::string &id, const T & /* obj */) override
+    {
+      size_t leaf = leafOf(hashId(id));
+      std::vector<spos_leaf_entry> &entries = _leaves[leaf];
+      for (size_t i = 0; i < entries.size(); i++)
+      {
+        if (entries[i].first == id)
+        {
+          update(leaf, 0, entries[i].second);
+          entries[i] = std::move(entries.back());
+          entries.pop_back();
+          return;
+        }
+      }
+    }
+
+    void onReplace(size_t /* pos */, const std::string &id, const T &obj) override
+    {
+      uint64_t idHash = hashId(id);
+      size_t leaf = leafOf(idHash);
+      std::vector<spos_leaf_entry> &entries = _leaves[leaf];
+      for (size_t i = 0; i < entries.size(); i++)
+      {
+        if (entries[i].first == id)
+        {
+          uint64_t hash = entryHash(idHash, obj);
+          update(leaf, hash, entries[i].second);
+          entries[i].second = hash;
+          return;
+        }
+      }
+    }
+
+    void onReset() override
+    {
+      _nodes.assign(size_t(2) << _depth, 0);
+      _leaves.assign(size_t(1) << _depth, std::vector<spos_leaf_entry>());
+    }
+
+    // ids only in this tree (added), only in the other tree (removed) or in both with different hashes (changed)
+    void diff(const spos_hash_tree<T> &other, std::vector<std::string> &added, std::vector<std::string> &removed, std::vector<std::string> &changed) const
+    {
+      diffNode(other, 1, added, removed, changed);
+    }
+
+    static uint64_t mix(uint64_t value)
+    {
+      value ^= value >> 30;
+      value *= 0xBF58476D1CE4E5B9ULL;
+      value ^= value >> 27;
+      value *= 0x94D049BB133111EBULL;
+      value ^= value >> 31;
+      return value;
+    }
+
+  private:
+    static uint64_t hashId(const std::string &id)
+    {
+      // FNV-1a
+      uint64_t hash = 0xCBF29CE484222325ULL;
+      for (size_t i = 0; i < id.length(); i++)
+      {
+        hash ^= uint8_t(id[i]);
+        hash *= 0x100000001B3ULL;
+      }
+      return mix(hash);
+    }
+
+    uint64_t entryHash(uint64_t idHash, const T &obj) const
+    {
+      return mix(idHash ^ mix(_hashCB(obj) + 0x9E3779B97F4A7C15ULL));
+    }
+
+    size_t leafOf(uint64_t idHash) const
+    {
+      return (_depth == 0) ? 0 : size_t(idHash >> (64 - _depth));
+    }
+
+    // add hash and remove oldHash on the path from leaf to root
+    void update(size_t leaf, uint64_t hash, uint64_t oldHash)
+    {
+      for (size_t node = leaf + (size_t(1) << _depth); node > 0; node /= 2)
+      {
+        _nodes[node] += hash - oldHash;
+      }
+    }
+
+    void diffNode(const spos_hash_tree<T> &other, size_t node, std::vector<std::string> &added, std::vector<std::string> &removed, std::vector<std::string> &changed) const
+    {
+      if (_nodes[node] == other._nodes[node])
+      {
+        return;
+      }
+      size_t firstLeaf = size_t(1) << _depth;
+      if (node < firstLeaf)
+      {
+        diffNode(other, 2 * node, added, removed, changed);
+        diffNode(other, 2 * node + 1, added, removed, changed);
+        return;
+      }
+      // compare the leaves' entries sorted by id
+      std::vector<spos_leaf_entry> mine(_leaves[node - firstLeaf]);
+      std::vector<spos_leaf_entry> theirs(other._leaves[node - firstLeaf]);
+      std::sort(mine.begin(), mine.end());
+      std::sort(theirs.begin(), theirs.end());
+      size_t i = 0;
+      size_t j = 0;
+      while ((i < mine.size()) || (j < theirs.size()))
+      {
+        if ((j >= theirs.size()) || ((i < mine.size()) && (mine[i].first < theirs[j].first)))
+        {
+          added.push_back(mine[i++].first);
+        }
+        else if ((i >= mine.size()) || (theirs[j].first < mine[i].first))
+        {
+          removed.push_back(theirs[j++].first);
+        }
+        else
+        {
+          if (mine[i].second != theirs[j].second)
+          {
+            changed.push_back(mine[i].first);
+          }
+          i++;
+          j++;
+        }
+      }
+    }
+};
+
+
+/**
+ * @brief enum for the type of change reported by a store's change feed
+ */
+enum sposChangeOp
+{
+  ChangeInsert,
+  ChangeReplace,
+  ChangeErase,
+  ChangeReset,
+  ChangeResort
+};
+
+
+/**
+ * @brief a change reported by a store's change feed, with obj being a copy of the object 
+ *        inserted or replaced (nullptr for other changes) and seq the store's sequence 
+ *        number of the change
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+struct sposChange
+{
+  sposChangeOp op;
+  std::string id;
+  std::shared_ptr<const T> obj;
+  uint64_t seq;
+};
+
+#if __cplusplus >= 201703L
+/**
+ * @brief an object or nothing, std::optional where available
+ * @tparam T  class typename of the object
+ */
+template <class T>
+using spos_optional = std::optional<T>;
+#else
+/**
+ * @brief an object or nothing, a minimal replacement of std::optional for C++11 / C++14
+ * @tparam T  class typename of the object
+ */
+template <class T>
+class spos_optional
+{
+  public:
+    spos_optional() : _hasValue(false) {}
+    spos_optional(const spos_optional<T> &other) : _hasValue(false)
+    {
+      if (other._hasValue)
+      {
+        emplace(*other);
+      }
+    }
+    spos_optional(spos_optional<T> &&other) noexcept(std::is_nothrow_move_constructible<T>::value) : _hasValue(false)
+    {
+      if (other._hasValue)
+      {
+        emplace(std::move(*other));
+      }
+    }
+    ~spos_optional()
+    {
+      reset();
+    }
+    spos_optional<T>& operator=(const spos_optional<T> &other)
+    {
+      if (this != &other)
+      {
+        reset();
+        if (other._hasValue)
+        {
+          emplace(*other);
+        }
+      }
+      return *this;
+    }
+    spos_optional<T>& operator=(spos_optional<T> &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+    {
+      if (this != &other)
+      {
+        reset();
+        if (other._hasValue)
+        {
+          emplace(std::move(*other));
+        }
+      }
+      return *this;
+    }
+
+    template <class... Vs>
+    T& emplace(Vs&&... args)
+    {
+      reset();
+      new (&_storage) T(std::forward<Vs>(args)...);
+      _hasValue = true;
+      return **this;
+    }
+    void reset()
+    {
+      if (_hasValue)
+      {
+        (**this).~T();
+        _hasValue = false;
+      }
+    }
+    bool has_value() const { return _hasValue; }
+    explicit operator bool() const { return _hasValue; }
+    T& operator*() { return *reinterpret_cast<T*>(&_storage); }
+    const T& operator*() const { return *reinterpret_cast<const T*>(&_storage); }
+    T* operator->() { return reinterpret_cast<T*>(&_storage); }
+    const T* operator->() const { return reinterpret_cast<const T*>(&_storage); }
+
+  private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    bool _hasValue;
+};
+#endif
+
+
+/**
+ * @brief an entry extracted from a store with extract(), owning its id and object, which 
+ *        can be inserted into a store of the same type with insert(), e.g. with a new id. 
+ *        obj is empty if nothing was extracted
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+struct sposNode
+{
+  std::string id;
+  spos_optional<T> obj;
+};
+
+
+/**
+ * @brief bounded lock-free queue of changes for one producer thread (the store's change 
+ *        callback) and one consumer thread (the follower)
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spObjectChangeQueue
+{
+  private:
+    std::vector<sposChange<T>> _slots;
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+
+  public:
+    spObjectChangeQueue(size_t capacity);
+    bool push(const sposChange<T> &change);
+    bool pop(sposChange<T> &change);
+    size_t popAll(std::vector<sposChange<T>> &changes, size_t maxCount = SIZE_MAX);
+    size_t getCapacity();
+};
+
+
+template <class T>
+class spObjectStore;
+
+
+/**
+ * @brief a query on a store, built from predicates joined by 'and', which uses the 
+ *        best matching index of the store to limit the entries to be checked
+ * @tparam T  class typename of objects stored
+ */
+template <class T>
+class spObjectQuery
+{
+   public:
+    /*  typedef for filter function
+        bool myFilterFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_filter_callback;
+
+   private:
+    /*  typedef for index lookup function
+        bool lookup(bool collect, std::vector<size_t> &positions, size_t &count, std::string &name);
+        returns false, if no index is available  */
+    typedef std::function<bool(bool, std::vector<size_t>&, size_t&, std::string&)> spos_lookup_callback;
+    struct spos_predicate
+    {
+      std::string text;
+      spos_filter_callback filter;
+      spos_lookup_callback lookup;
+    };
+    spObjectStore<T> *_store;
+    std::vector<spos_predicate> _predicates;
+
+    static std::string opText(sposOp op);
+    template <class M>
+    static typename std::enable_if<std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type isProjectionOf(spos_index<T> *index, M member);
+    template <class M>
+    static typename std::enable_if<!std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type isProjectionOf(spos_index<T> *index, M member);
+    template <class M>
+    static typename std::enable_if<std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type scanProjection(spos_index<T> *index, M member, sposOp op, const typename spos_member_traits<M>::value_type &value, bool collect, std::vector<size_t> &positions, size_t &count, std::string &name);
+    template <class M>
+    static typename std::enable_if<!std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type scanProjection(spos_index<T> *index, M member, sposOp op, const typename spos_member_traits<M>::value_type &value, bool collect, std::vector<size_t> &positions, size_t &count, std::string &name);
+    template <class U>
+    static typename std::enable_if<std::is_arithmetic<U>::value, std::string>::type valueText(const U &value);
+    template <class U>
+    static typename std::enable_if<!std::is_arithmetic<U>::value, std::string>::type valueText(const U &value);
+    static std::string valueText(const std::string &value);
+    int32_t plan(std::vector<size_t> &positions, bool collect, size_t &count, std::string &name);
+    void run(spos_filter_callback callback);
+
+   public:
+    spObjectQuery(spObjectStore<T> *store);
+    template <class M, class V>
+    typename std::enable_if<std::is_member_object_pointer<M>::value, spObjectQuery<T>&>::type andWhere(M member, sposOp op, const V &value);
+    spObjectQuery<T>& andWhereId(sposOp op, const std::string &id);
+    spObjectQuery<T>& andWhere(spos_filter_callback filter);
+    void forEach(std::function<bool(const T&)> callback);
+    void forEach(std::function<bool(const std::string&, const T&)> callback);
+    size_t count();
+    std::string explain();
+};
+
+
+/**
+ * @brief the object storage class
+ * @tparam T  class typename of objects to store
+ */
+template <class T>
+class spObjectStore
+{
+   public:
+    /*  typedef for comparison function
+        int myCmpFunc(const T &obj_A, const T &obj_B);
+        return value: <0 = A has lower value, 0 = same, >0 = A has higher value   */
+    typedef std::function<int(const T&, const T&)> spos_compare_callback;
+    /*  typedef for id creating function
+        std::string myCreateIdFunc(const T &obj);  */
+    typedef std::function<std::string(const T&)> spos_create_id_callback;
+    /*  typedef for interation function, object only
+        std::string myIterateFunc(const T &obj);  */
+    typedef std::function<bool(const T&)> spos_forEach_O_callback;
+    /*  typedef for interation function, id and object
+        std::string myIterateFunc(const std::string &id, const T &obj);  */
+    typedef std::function<bool(const std::string&, const T&)> spos_forEach_IO_callback;
+    /*  typedef for change function
+        void myChangeFunc(const sposChange<T> &change);  */
+    typedef std::function<void(const sposChange<T>&)> spos_change_callback;
+    /*  typedef for changed since function, id, object (nullptr if deleted) and version
+        bool myChangedFunc(const std::string &id, const T *obj, uint64_t version);  */
+    typedef std::function<bool(const std::string&, const T*, uint64_t)> spos_changed_callback;
+
+   private:
+    std::vector<std::string> _ids;
+    std::vector<T> _objects;
+    int32_t _index = -1;
+    size_t _capaInc = 10;
+    spos_compare_callback _compareCB;
+    bool _added = false;
+    sposSort _sorting = None;
+    std::string _idSep = "#/#";
+    uint32_t _autoId = 10000;
+    uint8_t _idNumDigits = 8;
+    uint8_t _idNumDecimals = 6;
+    uint8_t _idNumSize = 16;
+    spos_create_id_callback _createIdCB;
+    std::vector<std::unique_ptr<spos_index<T>>> _indexes;
+    spos_change_callback _changeCB;
+    uint64_t _changeSeq = 0;
+    bool _versioning = false;
+    std::unordered_map<std::string, std::pair<uint64_t, bool>> _versions;   // id -> version, deleted
+    std::vector<std::pair<uint64_t, std::string>> _versionLog;                // ordered by version
+    bool _batching = false;
+    bool _batchReset = false;
+    std::vector<sposChange<T>> _batch;
+    std::unordered_map<std::string, bool> _batchIds;                          // id -> stored after batch
+    size_t _writeBuffer = 0;
+    bool _lazySorting = false;
+    double _deferredDeletes = 0;
+    size_t _deletedCount = 0;
+    std::vector<uint8_t> _dead;                                               // per position, only while deleted entries exist
+    size_t _tailStart = 0;
+    std::unordered_map<std::string, size_t> _tailIds;                         // id -> position in unsorted tail
+
+    friend class spObjectQuery<T>;
+    template <class U>
+    friend class spObjectStore;
+
+    int32_t compareIds(const std::string &id1, const std::string &id2);
+    int32_t indexOf(const std::string &id, const T *obj);
+    int32_t locate(const std::string &id, const T *obj);
+    void setCapacity(size_t capacity);
+    void setAdded(bool added);
+    std::string stringify(const uint64_t &value);
+    std::string stringify(const uint32_t &value);
+    std::string stringify(const uint16_t &value);
+    std::string stringify(const uint8_t &value);
+    std::string stringify(const int64_t &value);
+    std::string stringify(const int32_t &value);
+    std::string stringify(const int16_t &value);
+    std::string stringify(const int8_t &value);
+    std::string stringify(const long double &value);
+    std::string stringify(const double &value);
+    std::string stringify(const float &value);
+    std::string stringify(const std::string &value);
+    std::string stringify(const char &value);
+    std::string makeIdFrom();
+    template<class U>
+    std::string makeIdFrom(U arg);
+    template<class U, class... Vs>
+    std::string makeIdFrom(U arg, Vs... args);
+    std::string createId(const T &obj);
+    void recreate(bool preserveIds);
+    bool isBetter(const spos_compare_callback &callback, bool largest, size_t posA, size_t posB);
+    std::vector<size_t> selectK(size_t k, const spos_compare_callback &callback, bool largest, size_t first, size_t last);
+    std::vector<size_t> selectKParallel(size_t k, const spos_compare_callback &callback, bool largest, size_t numThreads);
+    template <class... Vs>
+    void insertAt(size_t pos, const std::string &id, Vs&&... args);
+    void eraseAt(size_t pos, spos_optional<T> *taken = nullptr);
+    void deleteAt(size_t pos);
+    void normalize();
+    void notifyReplaced(size_t pos);
+    spos_index<T>* findIndex(const std::string &name);
+    template <class U>
+    spos_projection<T, U>* findProjection(const std::string &name);
+    spos_spatial_index<T>* findSpatialIndex(const std::string &name);
+    bool isSortedById();
+    void idRange(sposOp op, const std::string &id, size_t &first, size_t &last);
+    template <class U>
+    bool hasSameIdOrder(spObjectStore<U> &other);
+    size_t gallop(const std::vector<std::string> &ids, size_t first, size_t last, const std::string &id);
+    template <class U, class F>
+    bool matchRange(spObjectStore<U> &other, size_t firstA, size_t lastA, size_t firstB, size_t lastB, bool allA, F func);
+    template <class U, class F>
+    void matchAll(spObjectStore<U> &other, bool allA, F func);
+    void rebuildIndexes();
+    void emitChange(sposChangeOp op, const std::string &id, const T *obj);
+    static std::shared_ptr<const T> shareCopy(const T &obj, std::true_type);
+    static std::shared_ptr<const T> shareCopy(const T &obj, std::false_type);
+    void recordVersion(sposChangeOp op, const std::string &id);
+    void applyChanges(const std::vector<sposChange<T>> &changes, bool moveObjs);
+    void mergeChanges(const std::vector<sposChange<T>> &changes, std::vector<size_t> &order, bool moveObjs);
+    T takeObj(const T &obj, bool moveObj);
+    T takeObj(const T &obj, bool moveObj, std::true_type);
+    T takeObj(const T &obj, bool moveObj, std::false_type);
+    void extractStaged(const std::string &id, sposNode<T> &node, std::true_type);
+    void extractStaged(const std::string &id, sposNode<T> &node, std::false_type);
+    bool isStaged(const std::string &id);
+    T* stageObj(const std::string &id, std::shared_ptr<T> obj);
+    void stageErase(const std::string &id);
+    void sortEntries();
+    void compactEntries(const std::vector<uint8_t> &keep);
+    bool isBuffering();
+    std::vector<size_t> tailOrder();
+    void unionFrom(spObjectStore<T> &other, bool moveObjs);
+    void copySettings(const spObjectStore<T> &other);
+    void mergeEntries(std::vector<std::string> &ids, std::vector<T> &objects, bool inOrder);
+    template <class U>
+    void retainFrom(spObjectStore<U> &other, bool matching);
+
+   public:
+    spObjectStore();
+    spObjectStore(sposSort sorting);
+    spObjectStore(spos_compare_callback callback);
+    spObjectStore(const spObjectStore<T> &other);
+    spObjectStore(spObjectStore<T> &&other) = default;
+    spObjectStore<T>& operator=(const spObjectStore<T> &other);
+    spObjectStore<T>& operator=(spObjectStore<T> &&other) = default;
+    template <class... Vs>
+    T* addObjWithId(const std::string &id, Vs... args);
+    template <class... Vs>
+    T* addObjWithIdHint(size_t &hint, const std::string &id, Vs... args);
+    template <class... Vs>
+    T* addObjFromArgs(Vs... args);
+    T* setObjWithId(const std::string &id, T &newObj);
+    T* setObjWithId(const std::string &id, T &&newObj);
+    T* getObjById(const std::string &id);
+    template <class... Vs>
+    T* getObjFromArgs(Vs... args);
+    template <class... Vs>
+    std::string getIdFromArgs(Vs... args);
+    bool deleteObjById(const std::string &id);
+    template <class... Vs>
+    bool deleteObjFromArgs(Vs... args);
+    bool touchObjById(const std::string &id);
+    sposNode<T> extract(const std::string &id);
+    T* insert(sposNode<T> &&node);
+    bool rekey(const std::string &oldId, const std::string &newId);
+    void reset();
+    void forEach(spos_forEach_O_callback callback);
+    void forEach(spos_forEach_IO_callback callback);
+    void topK(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback);
+    void bottomK(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback);
+    void topKParallel(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback, size_t numThreads = 0);
+    void bottomKParallel(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback, size_t numThreads = 0);
+    size_t getCapacityInc();
+    void setCapacityInc(size_t newInc);
+    size_t getSize();
+    bool isAdded();
+    bool isSorted();
+    sposSort getSorting();
+    void setSorting(sposSort sorting);
+    std::string getIdSeparator();
+    void setIdSeparator(std::string separator);
+    uint8_t getIdNumDecimals();
+    void setIdNumDecimals(uint8_t decimals);
+    uint8_t getIdNumDigits();
+    void setIdNumDigits(uint8_t digits);
+    template <class... Vs>
+    std::string makeIdFromArgs(Vs... args);
+    void setCreateIdCallback(spos_create_id_callback callback);
+    void setCompareCallback(spos_compare_callback callback);
+    template <class M>
+    typename std::enable_if<std::is_member_object_pointer<M>::value, bool>::type addIndex(const std::string &name, M member);
+    bool removeIndex(const std::string &name);
+    bool hasIndex(const std::string &name);
+    template <class M>
+    typename std::enable_if<std::is_member_object_pointer<M>::value, bool>::type addProjection(const std::string &name, M member);
+    template <class U>
+    size_t projectionCount(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value);
+    template <class U>
+    typename spos_projection<T, U>::spos_sum_type projectionSum(const std::string &name);
+    template <class U>
+    typename spos_projection<T, U>::spos_sum_type projectionSum(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value);
+    template <class U>
+    std::vector<size_t> projectionFilter(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value);
+    bool addSpatialIndex(const std::string &name, typename spos_spatial_index<T>::spos_point_callback callback);
+    void nearest(const std::string &name, size_t k, const sposPoint &point, spos_forEach_IO_callback callback);
+    void withinBox(const std::string &name, const sposPoint &minPoint, const sposPoint &maxPoint, spos_forEach_IO_callback callback);
+    bool addTextIndex(const std::string &name, typename spos_text_index<T>::spos_text_callback callback = nullptr);
+    void findContaining(const std::string &name, const std::string &fragment, spos_forEach_IO_callback callback);
+    template <class U>
+    void join(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_join_callback callback);
+    template <class U>
+    void leftJoin(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_left_join_callback callback);
+    template <class U>
+    void antiJoin(spObjectStore<U> &other, spos_forEach_IO_callback callback);
+    template <class U>
+    void joinParallel(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_join_callback callback, size_t numThreads = 0);
+    spObjectStore<T> unionWith(spObjectStore<T> &other);
+    template <class U>
+    spObjectStore<T> intersectWith(spObjectStore<U> &other);
+    template <class U>
+    spObjectStore<T> differenceFrom(spObjectStore<U> &other);
+    void unionWithInPlace(spObjectStore<T> &other);
+    void unionWithInPlace(spObjectStore<T> &&other);
+    size_t spliceFrom(spObjectStore<T> &other, spos_forEach_IO_callback predicate);
+    spObjectStore<T> splitAt(const std::string &id);
+    void mergeFrom(spObjectStore<T> &other);
+    template <class U>
+    void intersectWithInPlace(spObjectStore<U> &other);
+    template <class U>
+    void differenceFromInPlace(spObjectStore<U> &other);
+    template <class U>
+    size_t countUnionWith(spObjectStore<U> &other);
+    template <class U>
+    size_t countIntersectWith(spObjectStore<U> &other);
+    template <class U>
+    size_t countDifferenceFrom(spObjectStore<U> &other);
+    bool addHashTree(const std::string &name, typename spos_hash_tree<T>::spos_hash_callback callback, uint8_t depth = 16);
+    bool diff(const std::string &name, spObjectStore<T> &other, std::vector<std::string> &added, std::vector<std::string> &removed, std::vector<std::string> &changed);
+    void setChangeCallback(spos_change_callback callback);
+    uint64_t getChangeSeq();
+    void applyChanges(const std::vector<sposChange<T>> &changes);
+    void setVersioning(bool versioning);
+    bool isVersioning();
+    uint64_t getVersionById(const std::string &id);
+    void forEachChangedSince(uint64_t version, spos_changed_callback callback);
+    size_t purgeTombstones(uint64_t version);
+    void beginBatch();
+    bool isBatching();
+    void commit();
+    void rollback();
+    void setWriteBuffer(size_t size);
+    size_t getWriteBuffer();
+    void mergeWriteBuffer();
+    void setLazySorting(bool lazy);
+    bool isLazySorting();
+    void setDeferredDeletes(double fraction);
+    double getDeferredDeletes();
+    size_t getDeletedCount();
+    void compactDeleted();
+    T* getObjAt(size_t pos);
+    std::string getIdAt(size_t pos);
+    template <class M, class V>
+    typename std::enable_if<std::is_member_object_pointer<M>::value, spObjectQuery<T>>::type where(M member, sposOp op, const V &value);
+    spObjectQuery<T> whereId(sposOp op, const std::string &id);
+    spObjectQuery<T> where(typename spObjectQuery<T>::spos_filter_callback filter);
+};
+
+
+/*    PUBLIC    PUBLIC    PUBLIC    PUBLIC    
+
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx      xxxxxx 
+      xx    xx  xx    xx  xx    xx  xx           xx     xx    xx
+      xx    xx  xx    xx  xx    xx  xx           xx     xx      
+      xxxxxxx   xx    xx  xxxxxxx   xx           xx     xx      
+      xx        xx    xx  xx    xx  xx           xx     xx      
+      xx        xx    xx  xx    xx  xx           xx     xx    xx
+      xx         xxxxxx   xxxxxxx   xxxxxxxx     xx      xxxxxx 
+     
+
+      PUBLIC    PUBLIC    PUBLIC    PUBLIC    */
+
+
+/**
+ * constructor - plain vanilla = no sorting
+ */
+template <class T>
+spObjectStore<T>::spObjectStore()
+{
+  _sorting = None;
+}
+
+/**
+ * constructor - sorting as None, ASC or DESC
+ */
+template <class T>
+spObjectStore<T>::spObjectStore(sposSort sorting)
+{
+  _sorting = sorting;
+}
+
+/**
+ * constructor - sorting by comparison callback
+ */
+template <class T>
+spObjectStore<T>::spObjectStore(spos_compare_callback callback)
+{
+  _sorting = None;
+  _compareCB = callback;
+}
+
+/**
+ * copy constructor - copies entries, settings and indexes
+ */
+template <class T>
+spObjectStore<T>::spObjectStore(const spObjectStore<T> &other)
+{
+  *this = other;
+}
+
+/**
+ * @brief Copy assignment, copying entries, settings and indexes
+ * 
+ * @param other  the store to copy from
+ * @return spObjectStore<T>& 
+ */
+template <class T>
+spObjectStore<T>& spObjectStore<T>::operator=(const spObjectStore<T> &other)
+{
+  if (this == &other)
+  {
+    return *this;
+  }
+  _ids = other._ids;
+  _objects = other._objects;
+  _index = -1;
+  copySettings(other);
+  _added = other._added;
+  _changeSeq = other._changeSeq;
+  _versions = other._versions;
+  _versionLog = other._versionLog;
+  _batching = other._batching;
+  _batchReset = other._batchReset;
+  _batch = other._batch;
+  _batchIds = other._batchIds;
+  _deletedCount = other._deletedCount;
+  _dead = other._dead;
+  _tailStart = other._tailStart;
+  _tailIds = other._tailIds;
+  return *this;
+}
+
+/**
+ * @brief Copy the settings and indexes of the other store, but not its entries
+ * 
+ * @param other  the store to copy from
+ */
+template <class T>
+void spObjectStore<T>::copySettings(const spObjectStore<T> &other)
+{
+  _capaInc = other._capaInc;
+  _compareCB = other._compareCB;
+  _sorting = other._sorting;
+  _idSep = other._idSep;
+  _autoId = other._autoId;
+  _idNumDigits = other._idNumDigits;
+  _idNumDecimals = other._idNumDecimals;
+  _idNumSize = other._idNumSize;
+  _createIdCB = other._createIdCB;
+  _versioning = other._versioning;
+  _writeBuffer = other._writeBuffer;
+  _lazySorting = other._lazySorting;
+  _deferredDeletes = other._deferredDeletes;
+  _indexes.clear();
+  for (size_t i = 0; i < other._indexes.size(); i++)
+  {
+    _indexes.emplace_back(other._indexes[i]->clone());
+  }
+}
+
+/**
+ * @brief Create an object, add it with the given id and return a pointer to it.
+ *        If an object with this id already exists, then a new object is 
+ *        stored under this id.
+ * 
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return T* pointer to object stored
+ */
+template<class T> template<class... Vs>
+T* spObjectStore<T>::addObjWithId(const std::string &id, Vs... args)
+{
+  if (_batching){
+    return stageObj(id, std::make_shared<T>(std::move(args)...));
+  }
+  if (indexOf(id, nullptr) == -1){
+    setAdded(true);
+    insertAt(_index, id, std::move(args)...);
+  } else {
+    setAdded(false);
+    _objects[_index] = T(std::move(args)...);
+    notifyReplaced(_index);
+  }
+  return &_objects[_index];
+}
+
+/**
+ * @brief Create an object, add it with the given id and return a pointer to it, like 
+ *        addObjWithId(), but checking the position hint and the one after it first, 
+ *        before searching the whole store. This is for adding sorted or nearly sorted 
+ *        ids, with hint being set to the position of the object stored for the next call
+ * 
+ * @param hint  position where the id is expected, e.g. the hint set by the previous call
+ * @param id  id of the object to store
+ * @param args optional arguments to construct T
+ * @return T* pointer to object stored
+ */
+template<class T> template<class... Vs>
+T* spObjectStore<T>::addObjWithIdHint(size_t &hint, const std::string &id, Vs... args)
+{
+  if (_batching || !isSortedById() || isBuffering())
+  {
+    T *obj = addObjWithId(id, std::move(args)...);
+    hint = _batching ? hint : _index;
+    return obj;
+  }
+  size_t count = _ids.size();
+  size_t pos = std::min(hint, count);
+  // sorted ids go right after the previous one
+  if ((pos < count) && (compareIds(_ids[pos], id) < 0))
+  {
+    pos++;
+  }
+  if (((pos > 0) && (compareIds(_ids[pos - 1], id) >= 0)) || ((pos < count) && (compareIds(_ids[pos], id) < 0)))
+  {
+    // wrong hint
+    T *obj = addObjWithId(id, std::move(args)...);
+    hint = _index;
+    return obj;
+  }
+  if ((pos < count) && (_ids[pos] == id) && ((_deletedCount == 0) || !_dead[pos]))
+  {
+    setAdded(false);
+    _objects[pos] = T(std::move(args)...);
+    notifyReplaced(pos);
+  }
+  else
+  {
+    // new entry or reusing a deleted one
+    setAdded(true);
+    insertAt(pos, id, std::move(args)...);
+  }
+  _index = pos;
+  hint = pos;
+  return &_objects[pos];
+}
+
+/**
+ * @brief Create an object, add it with an autocreated id and return a pointer to it.
+ * 
+ * @param args optional arguments to construct T
+ * @return T* pointer to object stored
+ */
+template<class T> template<class... Vs>
+T* spObjectStore<T>::addObjFromArgs(Vs ...args)
+{
+  T newObj = T(std::move(args)...);
+  std::string id = createId(newObj);
+  if (_batching){
+    return isStaged(id) ? nullptr : stageObj(id, std::make_shared<T>(std::move(newObj)));
+  }
+  // must be index of -1
+  if (indexOf(id, &newObj) == -1){
+    setAdded(true);
+    insertAt(_index, id, std::move(newObj));
+    return &_objects[_index];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Set a copy(!) of an object with the given id, which is either replacing 
+ *        an existing one or adding a new id - object pair. This is similar to 
+ *        addObjWithId() but using an object instead of args to create the stored object
+ * 
+ * @param id  id of the object to store
+ * @param newObj an object of class T, based on which a copy is created and stored
+ */
+template <class T>
+T* spObjectStore<T>::setObjWithId(const std::string &id, T &newObj)
+{
+  if (_batching){
+    return stageObj(id, std::make_shared<T>(newObj));
+  }
+  if (indexOf(id, &newObj) == -1){
+    setAdded(true);
+    insertAt(_index, id, newObj);
+  } else {
+    setAdded(false);
+    _objects[_index] = newObj;
+    notifyReplaced(_index);
+  }
+  return &_objects[_index];
+}
+
+/**
+ * @brief Set an object with the given id by moving it into the store, which is either 
+ *        replacing an existing one or adding a new id - object pair. This is for objects
+ *        which cannot or should not be copied
+ * 
+ * @param id  id of the object to store
+ * @param newObj an object of class T, which is moved into the store
+ */
+template <class T>
+T* spObjectStore<T>::setObjWithId(const std::string &id, T &&newObj)
+{
+  if (_batching){
+    return stageObj(id, std::make_shared<T>(std::move(newObj)));
+  }
+  if (indexOf(id, &newObj) == -1){
+    setAdded(true);
+    insertAt(_index, id, std::move(newObj));
+  } else {
+    setAdded(false);
+    _objects[_index] = std::move(newObj);
+    notifyReplaced(_index);
+  }
+  return &_objects[_index];
+}
+
+/**
+ * @brief Get an object with the given id and return a pointer to it.
+ *        If no object with this id exists, a nullptr is returned
+ * 
+ * @param id  id of the object to find
+ * @return T* pointer to object stored 
+ */
+template<class T>
+T* spObjectStore<T>::getObjById(const std::string &id)
+{
+  if (indexOf(id, nullptr) > -1){
+    return &_objects[_index];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Get an object with the given object arguments and return a pointer to it.
+ *        If no object with these arguments exists, a nullptr is returned
+ * 
+ * @param args arguments used when object was constructed 
+ * @return T* pointer to object stored 
+ */
+template<class T> template<class... Vs>
+T* spObjectStore<T>::getObjFromArgs(Vs... args)
+{
+  T obj = T(args...);
+  if (indexOf("", &obj) > -1){
+    return &_objects[_index];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Get the id of the object with the given arguments.
+ *        If no object with these arguments exists, an empty string is returned
+ * 
+ * @param args arguments used when object was constructed 
+ * @return std::string  the id of the object stored
+ */
+template<class T> template<class... Vs>
+std::string spObjectStore<T>::getIdFromArgs(Vs... args)
+{
+  T obj = T(args...);
+  if (indexOf("", &obj) > -1){
+    return _ids[_index];
+  }
+  return "";
+}
+
+/**
+ * @brief Delete the object with the given id and return success
+ * 
+ * @param id  id of the object to delete
+ * @return true / false 
+ */
+template<class T>
+bool spObjectStore<T>::deleteObjById(const std::string &id)
+{
+  if (_batching){
+    if (!isStaged(id)){
+      return false;
+    }
+    stageErase(id);
+    return true;
+  }
+  if (indexOf(id, nullptr) == -1){
+    return false;
+  }
+  deleteAt(_index);
+  return true;
+}
+
+/**
+ * @brief Delete the object with the given object arguments and return success
+ * 
+ * @param args arguments used when object was constructed 
+ * @return true / false 
+ */
+template<class T> template<class... Vs>
+bool spObjectStore<T>::deleteObjFromArgs(Vs ...args)
+{
+  T obj = T(args...);
+  if (indexOf("", &obj) == -1){
+    return false;
+  }
+  if (_batching){
+    if (!isStaged(_ids[_index])){
+      return false;
+    }
+    stageErase(_ids[_index]);
+    return true;
+  }
+  deleteAt(_index);
+  return true;
+}
+
+/**
+ * @brief Tell the store that the object with the given id was changed via its pointer,
+ *        so that indexes depending on the object's values are updated. Returns false
+ *        if no object with this id exists
+ * 
+ * @param id  id of the object changed
+ * @return true / false 
+ */
+template<class T>
+bool spObjectStore<T>::touchObjById(const std::string &id)
+{
+  if (indexOf(id, nullptr) == -1){
+    return false;
+  }
+  notifyReplaced(_index);
+  return true;
+}
+
+/**
+ * @brief Remove the object with the given id from the store and return it with its id
+ *        as a node, moving instead of copying the object. The node is empty if no 
+ *        object with this id exists. In a batch the erase is staged and the node 
+ *        holds a copy, which is empty for objects that cannot be copied
+ * 
+ * @param id  id of the object to extract
+ * @return sposNode<T> node owning the id and the object
+ */
+template<class T>
+sposNode<T> spObjectStore<T>::extract(const std::string &id)
+{
+  sposNode<T> node;
+  if (_batching){
+    extractStaged(id, node, std::is_copy_constructible<T>());
+    return node;
+  }
+  if (indexOf(id, nullptr) == -1){
+    return node;
+  }
+  node.id = _ids[_index];
+  eraseAt(_index, &node.obj);
+  return node;
+}
+
+/**
+ * @brief Extract in a batch: stage the erase and copy the object into node, as the stored 
+ *        object is kept for a rollback. Objects that cannot be copied are not extracted
+ * 
+ * @param id  id of the object to extract
+ * @param node  node receiving the id and the copy
+ */
+template<class T>
+void spObjectStore<T>::extractStaged(const std::string &id, sposNode<T> &node, std::true_type)
+{
+  if (!isStaged(id)){
+    return;
+  }
+  auto it = std::find_if(_batch.rbegin(), _batch.rend(), [&id](const sposChange<T> &change) { return change.id == id; });
+  if ((it != _batch.rend()) && (it->obj != nullptr)){
+    node.obj.emplace(*it->obj);
+  } else if (indexOf(id, nullptr) > -1){
+    node.obj.emplace(_objects[_index]);
+  } else {
+    return;
+  }
+  node.id = id;
+  stageErase(id);
+}
+template<class T>
+void spObjectStore<T>::extractStaged(const std::string & /* id */, sposNode<T> & /* node */, std::false_type)
+{
+}
+
+/**
+ * @brief Insert the object of a node returned by extract() with the node's id, moving 
+ *        instead of copying the object, and return a pointer to it. An object with 
+ *        the same id is replaced. Returns nullptr if the node is empty, which it is 
+ *        afterwards
+ * 
+ * @param node  node owning the id and the object
+ * @return T* pointer to the object stored
+ */
+template<class T>
+T* spObjectStore<T>::insert(sposNode<T> &&node)
+{
+  if (!node.obj){
+    return nullptr;
+  }
+  T *obj;
+  if (_batching){
+    obj = stageObj(node.id, std::make_shared<T>(std::move(*node.obj)));
+  } else if (indexOf(node.id, &*node.obj) == -1){
+    setAdded(true);
+    insertAt(_index, node.id, std::move(*node.obj));
+    obj = &_objects[_index];
+  } else {
+    setAdded(false);
+    _objects[_index] = std::move(*node.obj);
+    notifyReplaced(_index);
+    obj = &_objects[_index];
+  }
+  node.obj.reset();
+  return obj;
+}
+
+/**
+ * @brief Change the id of an object and return success, which fails if no object with
+ *        oldId or one with newId exists. Stores sorted by ids rotate the entries between
+ *        the old and the new position by one, others extract and insert the object, so
+ *        the object is moved and never copied
+ * 
+ * @param oldId  current id of the object
+ * @param newId  new id of the object
+ * @return true / false
+ */
+template<class T>
+bool spObjectStore<T>::rekey(const std::string &oldId, const std::string &newId)
+{
+  // isStaged() finds stored ids outside of batches, too
+  if (!isStaged(oldId) || isStaged(newId)){
+    return false;
+  }
+  if (_batching || !isSortedById() || !_tailIds.empty() || (_deletedCount > 0)){
+    sposNode<T> node = extract(oldId);
+    node.id = newId;
+    return insert(std::move(node)) != nullptr;
+  }
+  indexOf(newId, nullptr);
+  size_t newPos = _index;
+  indexOf(oldId, nullptr);
+  size_t oldPos = _index;
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onErase(oldPos, _ids[oldPos], _objects[oldPos]);
+  }
+  emitChange(ChangeErase, _ids[oldPos], nullptr);
+  // the entry leaves its old position before it takes the new one
+  size_t pos = (newPos > oldPos) ? newPos - 1 : newPos;
+  size_t first = std::min(oldPos, newPos);
+  size_t middle = (newPos > oldPos) ? oldPos + 1 : oldPos;
+  size_t last = (newPos > oldPos) ? newPos : oldPos + 1;
+  std::rotate(_ids.begin() + first, _ids.begin() + middle, _ids.begin() + last);
+  std::rotate(_objects.begin() + first, _objects.begin() + middle, _objects.begin() + last);
+  _ids[pos] = newId;
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onInsert(pos, _ids[pos], _objects[pos]);
+  }
+  emitChange(ChangeInsert, _ids[pos], &_objects[pos]);
+  _index = pos;
+  return true;
+}
+
+/**
+ * @brief Delete all objects
+ * 
+ */
+template <class T>
+void spObjectStore<T>::reset()
+{
+  if (_batching)
+  {
+    sposChange<T> change;
+    change.op = ChangeReset;
+    change.seq = 0;
+    _batch.push_back(change);
+    _batchIds.clear();
+    _batchReset = true;
+    return;
+  }
+  _ids.clear();
+  _objects.clear();
+  _tailIds.clear();
+  _dead.clear();
+  _deletedCount = 0;
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onReset();
+  }
+  emitChange(ChangeReset, "", nullptr);
+}
+
+/**
+ * @brief Loop through all entries and call function callback(obj)
+ * 
+ * @param callback  function of type func(const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::forEach(spos_forEach_O_callback callback)
+{
+  if (!_tailIds.empty())
+  {
+    forEach([&callback](const std::string &, const T &obj) { return callback(obj); });
+    return;
+  }
+  size_t count = _objects.size();
+  for (size_t i = 0; i < count; i++) {
+    if ((_deletedCount > 0) && _dead[i]){
+      continue;
+    }
+    if (callback(_objects.at(i)) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Loop through all entries and call function callback(id, obj)
+ * 
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::forEach(spos_forEach_IO_callback callback)
+{
+  if (_lazySorting)
+  {
+    mergeWriteBuffer();
+  }
+  if (!_tailIds.empty())
+  {
+    // two-way merge of the sorted entries and the sorted write buffer
+    std::vector<size_t> tail = tailOrder();
+    size_t posA = 0;
+    size_t posB = 0;
+    while ((posA < _tailStart) || (posB < tail.size()))
+    {
+      size_t pos;
+      if ((posB >= tail.size()) || ((posA < _tailStart) && (compareIds(_ids[posA], _ids[tail[posB]]) < 0)))
+      {
+        pos = posA++;
+      }
+      else
+      {
+        pos = tail[posB++];
+      }
+      if ((_deletedCount > 0) && _dead[pos])
+      {
+        continue;
+      }
+      if (callback(_ids[pos], _objects[pos]) == false)
+      {
+        return;
+      }
+    }
+    return;
+  }
+  size_t count = _objects.size();
+  for (size_t i = 0; i < count; i++) {
+    if ((_deletedCount > 0) && _dead[i]){
+      continue;
+    }
+    if (callback(_ids[i] , _objects.at(i)) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Call function callback(id, obj) for the k entries with the highest values
+ *        as determined by the compare function, starting with the highest one.
+ *        The store itself is not re-sorted, the selection uses a bounded heap
+ *        over the entries' positions, i.e. O(n log k)
+ * 
+ * @param k  number of entries to select
+ * @param compare  function of type func(const class &obj1, const class &obj2)
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::topK(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback)
+{
+  std::vector<size_t> selected = selectK(k, compare, true, 0, _objects.size());
+  for (size_t i = 0; i < selected.size(); i++) {
+    if (callback(_ids[selected[i]], _objects[selected[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Call function callback(id, obj) for the k entries with the lowest values
+ *        as determined by the compare function, starting with the lowest one.
+ *        The store itself is not re-sorted
+ * 
+ * @param k  number of entries to select
+ * @param compare  function of type func(const class &obj1, const class &obj2)
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::bottomK(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback)
+{
+  std::vector<size_t> selected = selectK(k, compare, false, 0, _objects.size());
+  for (size_t i = 0; i < selected.size(); i++) {
+    if (callback(_ids[selected[i]], _objects[selected[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Same as topK(), but with the entries partitioned across threads, each
+ *        selecting its own k candidates, which are then merged. The compare function
+ *        is called concurrently and must therefore not modify shared state
+ * 
+ * @param k  number of entries to select
+ * @param compare  function of type func(const class &obj1, const class &obj2)
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ * @param numThreads  number of threads to use, 0 for the number of hardware threads
+ */
+template <class T>
+void spObjectStore<T>::topKParallel(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback, size_t numThreads)
+{
+  std::vector<size_t> selected = selectKParallel(k, compare, true, numThreads);
+  for (size_t i = 0; i < selected.size(); i++) {
+    if (callback(_ids[selected[i]], _objects[selected[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Same as bottomK(), but with the entries partitioned across threads, each
+ *        selecting its own k candidates, which are then merged. The compare function
+ *        is called concurrently and must therefore not modify shared state
+ * 
+ * @param k  number of entries to select
+ * @param compare  function of type func(const class &obj1, const class &obj2)
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ * @param numThreads  number of threads to use, 0 for the number of hardware threads
+ */
+template <class T>
+void spObjectStore<T>::bottomKParallel(size_t k, spos_compare_callback compare, spos_forEach_IO_callback callback, size_t numThreads)
+{
+  std::vector<size_t> selected = selectKParallel(k, compare, false, numThreads);
+  for (size_t i = 0; i < selected.size(); i++) {
+    if (callback(_ids[selected[i]], _objects[selected[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Returns the value by which the capacity is incremented when needed
+ * 
+ * @return int32_t value of increment
+ */
+template <class T>
+size_t spObjectStore<T>::getCapacityInc()
+{
+  return _capaInc;
+}
+
+/**
+ * @brief Set the value used to increment the capacity when needed
+ * 
+ * @param newInc value of new increment
+ */
+template <class T>
+void spObjectStore<T>::setCapacityInc(size_t newInc)
+{
+  if (newInc > 1){
+    _capaInc = newInc;
+  }
+}
+
+/**
+ * @brief Returns the number of objects in the store
+ * 
+ * @return size_t number
+ */
+template <class T>
+size_t spObjectStore<T>::getSize()
+{
+  return _ids.size() - _deletedCount;
+}
+
+/**
+ * @brief Returns the status of last call to addObjWithId(), addObjFromArgs() and 
+ *        setObjWithId() with regard to a new entry having been added 
+ * 
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::isAdded()
+{
+  return _added;
+}
+
+/**
+ * @brief Returns whether or not the store is sorted 
+ * 
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::isSorted()
+{
+  return ((_compareCB != nullptr) || (_sorting != None));
+}
+
+/**
+ * @brief Returns the current sorting method
+ * 
+ * @tparam T 
+ * @return sposSort 
+ */
+template <class T>
+sposSort spObjectStore<T>::getSorting()
+{
+  return _sorting;
+}
+
+/**
+ * @brief Set the sorting
+ * 
+ * @param sorting  either None, ASC or DESC
+ */
+template <class T>
+void spObjectStore<T>::setSorting(sposSort sorting)
+{
+  if (sorting == _sorting)
+  {
+    return;
+  }
+  _sorting = sorting;
+
+  if (sorting != None)
+  {
+    // recreate with preserved ids
+    recreate(true);
+  }
+}
+
+/**
+ * @brief Returns the string used as separator when creating ids from arguments. 
+ *        The default is '#/#', which is producing ids of key1#/#key2.. pattern
+ * 
+ * @return std::string  the separator
+ */
+template <class T>
+std::string spObjectStore<T>::getIdSeparator()
+{
+  return _idSep;
+}
+
+/**
+ * @brief Set the string to be used as separator when creating ids from arguments. 
+ *        The default is '#/#', which is producing ids of key1#/#key2.. pattern
+ * 
+ * @param separator 
+ */
+template <class T>
+void spObjectStore<T>::setIdSeparator(std::string separator)
+{
+  if (separator.length() > 0)
+  {
+    _idSep = separator;
+  }
+}
+
+/**
+ * @brief Returns the number of decimals used to format an id from a floating point value.
+ *        
+ * @return uint8_t  the length of string for decimals portion of value
+ */
+template <class T>
+uint8_t spObjectStore<T>::getIdNumDecimals()
+{
+  return _idNumDecimals;
+}
+
+/**
+ * @brief Set the number of decimals used to format an id from a floating point value.
+ * 
+ * @param digits  the length of the string for the decimals portion of a value
+ */
+template <class T>
+void spObjectStore<T>::setIdNumDecimals(uint8_t decimals)
+{
+  if (decimals > 0)
+  {
+    _idNumDecimals = decimals;
+  }
+}
+
+/**
+ * @brief Returns the number of digits used to format an id from a numeric value.
+ *        
+ * @return uint8_t  the length of the string (integer portion for floating point value)
+ */
+template <class T>
+uint8_t spObjectStore<T>::getIdNumDigits()
+{
+  return _idNumDigits;
+}
+
+/**
+ * @brief Set the number of digits used to format an id from a numeric value.
+ * 
+ * @param digits  the length of the string (integer portion for floating point value)
+ */
+template <class T>
+void spObjectStore<T>::setIdNumDigits(uint8_t digits)
+{
+  if (digits > 0)
+  {
+    _idNumDigits = digits;
+  }
+}
+
+/**
+ * @brief Returns an id created from arguments. In case no argument is given,
+ *        an auto generated one will be returned
+ * 
+ * @param args  any arguments privide will be concatenated into an id
+ * @return std::string  the id created
+ */
+template <class T> template <class... Vs>
+std::string spObjectStore<T>::makeIdFromArgs(Vs... args)
+{
+  int8_t numArgs = sizeof...(args);
+  if (numArgs > 0)
+  {
+    return makeIdFrom(args...);
+  }
+  else
+  {
+    return makeIdFrom(_autoId++);
+  }
+}
+
+/**
+ * @brief Set the callback to be invoked for creating ids and then rebuild 
+ *        all stored ids. If needed, sort all existing entries
+ * 
+ * @param callback  function of type func(const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::setCreateIdCallback(spos_create_id_callback callback)
+{
+  if (&_createIdCB == &callback)
+  {
+    return;
+  }
+  _createIdCB = callback;
+
+  // recreate with new ids
+  recreate(false);
+}
+
+/**
+ * @brief Set the callback to be invoked when sorting objects (i.e. comparing two objects)
+ *        and sort all existing entries
+ * 
+ * @param callback  function of type func(const class &obj1, const class &obj2)
+ */
+template <class T>
+void spObjectStore<T>::setCompareCallback(spos_compare_callback callback)
+{
+  if (&_compareCB == &callback)
+  {
+    return;
+  }
+  _compareCB = callback;
+
+  // recreate with preserved ids
+  recreate(true);
+}
+
+
+
+
+/**
+ * @brief Add a secondary index with the given name on a member of the stored objects, 
+ *        which is used by queries with predicates on this member. The index is kept in 
+ *        sync with all changes made through the store's functions, whereas changes made 
+ *        via object pointers need to be followed by touchObjById().
+ *        Returns false if an index with this name already exists
+ * 
+ * @param name  name of the index
+ * @param member  pointer to the member, e.g. &myObject::_number
+ * @return true / false 
+ */
+template <class T> template <class M>
+typename std::enable_if<std::is_member_object_pointer<M>::value, bool>::type spObjectStore<T>::addIndex(const std::string &name, M member)
+{
+  typedef typename spos_member_traits<M>::value_type U;
+  if (findIndex(name) != nullptr)
+  {
+    return false;
+  }
+  spos_index<T> *index = new spos_sorted_index<T, U>(name, member);
+  compactDeleted();
+  index->onRebuild(_ids, _objects);
+  _indexes.emplace_back(index);
+  return true;
+}
+
+/**
+ * @brief Remove the index with the given name and return success
+ * 
+ * @param name  name of the index
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::removeIndex(const std::string &name)
+{
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    if (_indexes[i]->_name == name)
+    {
+      _indexes.erase(_indexes.begin() + i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Returns whether an index with the given name exists
+ * 
+ * @param name  name of the index
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::hasIndex(const std::string &name)
+{
+  return findIndex(name) != nullptr;
+}
+
+/**
+ * @brief Returns a query with a first predicate comparing a member of the objects with
+ *        a value. Further predicates are added with the query's andWhere() functions
+ * 
+ * @param member  pointer to the member, e.g. &myObject::_number
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @return spObjectQuery<T> 
+ */
+template <class T> template <class M, class V>
+typename std::enable_if<std::is_member_object_pointer<M>::value, spObjectQuery<T>>::type spObjectStore<T>::where(M member, sposOp op, const V &value)
+{
+  spObjectQuery<T> query(this);
+  query.andWhere(member, op, value);
+  return query;
+}
+
+/**
+ * @brief Returns a query with a first predicate comparing the ids with a value. 
+ *        Further predicates are added with the query's andWhere() functions
+ * 
+ * @param op  comparison operator
+ * @param id  value to compare with
+ * @return spObjectQuery<T> 
+ */
+template <class T>
+spObjectQuery<T> spObjectStore<T>::whereId(sposOp op, const std::string &id)
+{
+  spObjectQuery<T> query(this);
+  query.andWhereId(op, id);
+  return query;
+}
+
+/**
+ * @brief Returns a query with a first predicate being a filter function. 
+ *        Further predicates are added with the query's andWhere() functions
+ * 
+ * @param filter  function of type func(const std::string &id, const class &obj)
+ * @return spObjectQuery<T> 
+ */
+template <class T>
+spObjectQuery<T> spObjectStore<T>::where(typename spObjectQuery<T>::spos_filter_callback filter)
+{
+  spObjectQuery<T> query(this);
+  query.andWhere(filter);
+  return query;
+}
+
+
+
+/**
+ * @brief Add a projection with the given name on an arithmetic member of the stored 
+ *        objects. The member's values are kept in a contiguous column in store order, 
+ *        which is scanned by projectionCount(), projectionSum() and projectionFilter() 
+ *        and by queries with predicates on this member. Like indexes, projections are
+ *        kept in sync with all changes made through the store's functions, whereas 
+ *        changes made via object pointers need to be followed by touchObjById().
+ *        Returns false if an index or projection with this name already exists
+ * 
+ * @param name  name of the projection
+ * @param member  pointer to the member, e.g. &myObject::_number
+ * @return true / false 
+ */
+template <class T> template <class M>
+typename std::enable_if<std::is_member_object_pointer<M>::value, bool>::type spObjectStore<T>::addProjection(const std::string &name, M member)
+{
+  typedef typename spos_member_traits<M>::value_type U;
+  if (findIndex(name) != nullptr)
+  {
+    return false;
+  }
+  spos_index<T> *projection = new spos_projection<T, U>(name, member);
+  compactDeleted();
+  projection->onRebuild(_ids, _objects);
+  _indexes.emplace_back(projection);
+  return true;
+}
+
+/**
+ * @brief Returns the number of entries with the projected member matching op and value.
+ *        U must be given explicitly as the type of the projected member, e.g. 
+ *        projectionCount<uint32_t>(..), and value is converted to it. For another type
+ *        no projection is found and 0 is returned
+ * 
+ * @param name  name of the projection
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @return size_t number
+ */
+template <class T> template <class U>
+size_t spObjectStore<T>::projectionCount(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value)
+{
+  spos_projection<T, U> *projection = findProjection<U>(name);
+  if (projection == nullptr)
+  {
+    return 0;
+  }
+  return projection->count(op, value);
+}
+
+/**
+ * @brief Returns the sum of the projected member over all entries, as int64_t, uint64_t 
+ *        or double depending on the member's type. U must be the type of the projected 
+ *        member, e.g. projectionSum<uint32_t>(..), otherwise 0 is returned
+ * 
+ * @param name  name of the projection
+ * @return sum of values
+ */
+template <class T> template <class U>
+typename spos_projection<T, U>::spos_sum_type spObjectStore<T>::projectionSum(const std::string &name)
+{
+  spos_projection<T, U> *projection = findProjection<U>(name);
+  if (projection == nullptr)
+  {
+    return 0;
+  }
+  return projection->sum();
+}
+
+/**
+ * @brief Returns the sum of the projected member over the entries matching op and value.
+ *        U must be given explicitly as the type of the projected member, otherwise 0 
+ *        is returned
+ * 
+ * @param name  name of the projection
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @return sum of values
+ */
+template <class T> template <class U>
+typename spos_projection<T, U>::spos_sum_type spObjectStore<T>::projectionSum(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value)
+{
+  spos_projection<T, U> *projection = findProjection<U>(name);
+  if (projection == nullptr)
+  {
+    return 0;
+  }
+  return projection->sum(op, value);
+}
+
+/**
+ * @brief Returns the positions of the entries with the projected member matching op and 
+ *        value in ascending order, see getObjAt() and getIdAt(). U must be given 
+ *        explicitly as the type of the projected member, otherwise no positions are 
+ *        returned
+ * 
+ * @param name  name of the projection
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @return std::vector<size_t>  positions
+ */
+template <class T> template <class U>
+std::vector<size_t> spObjectStore<T>::projectionFilter(const std::string &name, sposOp op, const typename spos_non_deduced<U>::type &value)
+{
+  std::vector<size_t> positions;
+  spos_projection<T, U> *projection = findProjection<U>(name);
+  if (projection != nullptr)
+  {
+    projection->filter(op, value, positions);
+  }
+  return positions;
+}
+
+/**
+ * @brief Add a spatial index with the given name over the points (lat, lon) returned by
+ *        the callback for each object, which is used by nearest() and withinBox(). It is
+ *        kept in sync like other indexes and needs touchObjById() after changes via 
+ *        object pointers. Returns false if an index with this name already exists
+ * 
+ * @param name  name of the index
+ * @param callback  function of type sposPoint func(const class &obj)
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::addSpatialIndex(const std::string &name, typename spos_spatial_index<T>::spos_point_callback callback)
+{
+  if ((findIndex(name) != nullptr) || (callback == nullptr))
+  {
+    return false;
+  }
+  spos_index<T> *index = new spos_spatial_index<T>(name, callback);
+  compactDeleted();
+  index->onRebuild(_ids, _objects);
+  _indexes.emplace_back(index);
+  return true;
+}
+
+/**
+ * @brief Call function callback(id, obj) for the k entries nearest to point, starting 
+ *        with the nearest one. The distance is the planar one between (lat, lon) values
+ * 
+ * @param name  name of the spatial index
+ * @param k  number of entries to find
+ * @param point  the point to search from
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::nearest(const std::string &name, size_t k, const sposPoint &point, spos_forEach_IO_callback callback)
+{
+  spos_spatial_index<T> *index = findSpatialIndex(name);
+  if (index == nullptr)
+  {
+    return;
+  }
+  std::vector<std::pair<double, size_t>> found;
+  index->nearest(k, point, found);
+  for (size_t i = 0; i < found.size(); i++) {
+    if (callback(_ids[found[i].second], _objects[found[i].second]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Call function callback(id, obj) in store order for all entries with their point 
+ *        within the box given by its lower and upper corner (inclusive)
+ * 
+ * @param name  name of the spatial index
+ * @param minPoint  lower corner, i.e. lowest lat and lon
+ * @param maxPoint  upper corner, i.e. highest lat and lon
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::withinBox(const std::string &name, const sposPoint &minPoint, const sposPoint &maxPoint, spos_forEach_IO_callback callback)
+{
+  spos_spatial_index<T> *index = findSpatialIndex(name);
+  if (index == nullptr)
+  {
+    return;
+  }
+  std::vector<size_t> positions;
+  index->withinBox(minPoint, maxPoint, positions);
+  std::sort(positions.begin(), positions.end());
+  for (size_t i = 0; i < positions.size(); i++) {
+    if (callback(_ids[positions[i]], _objects[positions[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Add a trigram index with the given name over the ids or, if a callback is given, 
+ *        over the text returned by the callback for each object, which is used by 
+ *        findContaining(). It is kept in sync like other indexes and needs touchObjById() 
+ *        after changes via object pointers. Returns false if an index with this name 
+ *        already exists
+ * 
+ * @param name  name of the index
+ * @param callback  optional function of type std::string func(const class &obj)
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::addTextIndex(const std::string &name, typename spos_text_index<T>::spos_text_callback callback)
+{
+  if (findIndex(name) != nullptr)
+  {
+    return false;
+  }
+  spos_index<T> *index = new spos_text_index<T>(name, callback);
+  compactDeleted();
+  index->onRebuild(_ids, _objects);
+  _indexes.emplace_back(index);
+  return true;
+}
+
+/**
+ * @brief Call function callback(id, obj) in store order for all entries, whose id or 
+ *        text (depending on the index) contains the fragment
+ * 
+ * @param name  name of the text index
+ * @param fragment  the text to look for
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T>
+void spObjectStore<T>::findContaining(const std::string &name, const std::string &fragment, spos_forEach_IO_callback callback)
+{
+  spos_index<T> *index = findIndex(name);
+  if ((index == nullptr) || (index->_typeTag != spos_type_tag<spos_text_index<T>>()))
+  {
+    return;
+  }
+  std::vector<size_t> positions;
+  static_cast<spos_text_index<T>*>(index)->find(fragment, _ids, _objects, positions);
+  for (size_t i = 0; i < positions.size(); i++) {
+    if (callback(_ids[positions[i]], _objects[positions[i]]) == false){
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Call function callback(id, obj, otherObj) in store order for all ids existing 
+ *        in this and the other store. When both stores are sorted by ids in the same 
+ *        direction, this is a single merge over both stores, otherwise the other store's 
+ *        ids are looked up in a temporary hash table
+ * 
+ * @param other  the store to join with
+ * @param callback  function of type func(const std::string &id, const class &obj, const otherClass &otherObj)
+ */
+template <class T> template <class U>
+void spObjectStore<T>::join(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_join_callback callback)
+{
+  matchAll(other, false, [this, &other, &callback](size_t posA, size_t posB) {
+    return callback(_ids[posA], _objects[posA], other._objects[posB]);
+  });
+}
+
+/**
+ * @brief Call function callback(id, obj, otherObj) in store order for all entries of this
+ *        store, with otherObj being a pointer to the object with the same id in the other 
+ *        store or a nullptr if there is none
+ * 
+ * @param other  the store to join with
+ * @param callback  function of type func(const std::string &id, const class &obj, const otherClass *otherObj)
+ */
+template <class T> template <class U>
+void spObjectStore<T>::leftJoin(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_left_join_callback callback)
+{
+  matchAll(other, true, [this, &other, &callback](size_t posA, size_t posB) {
+    return callback(_ids[posA], _objects[posA], (posB == SIZE_MAX) ? nullptr : &other._objects[posB]);
+  });
+}
+
+/**
+ * @brief Call function callback(id, obj) in store order for all entries of this store, 
+ *        whose id does not exist in the other store
+ * 
+ * @param other  the store to compare with
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
+template <class T> template <class U>
+void spObjectStore<T>::antiJoin(spObjectStore<U> &other, spos_forEach_IO_callback callback)
+{
+  matchAll(other, true, [this, &callback](size_t posA, size_t posB) {
+    return (posB != SIZE_MAX) || callback(_ids[posA], _objects[posA]);
+  });
+}
+
+/**
+ * @brief Same as join(), but with both stores split into matching id ranges, which are 
+ *        merged by separate threads. Requires both stores to be sorted by ids in the same 
+ *        direction, otherwise join() is used. The callback is called after all threads 
+ *        are done, from the calling thread
+ * 
+ * @param other  the store to join with
+ * @param callback  function of type func(const std::string &id, const class &obj, const otherClass &otherObj)
+ * @param numThreads  number of threads to use, 0 for the number of hardware threads
+ */
+template <class T> template <class U>
+void spObjectStore<T>::joinParallel(spObjectStore<U> &other, typename spos_join_types<T, U>::spos_join_callback callback, size_t numThreads)
+{
+  normalize();
+  other.normalize();
+  size_t count = _ids.size();
+  if (numThreads == 0)
+  {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  // not worth starting threads for small ranges
+  numThreads = std::min(numThreads, count / 1024);
+  if ((numThreads < 2) || !hasSameIdOrder(other))
+  {
+    join(other, callback);
+    return;
+  }
+
+  // split this store evenly and the other one at the matching ids
+  std::vector<size_t> splitA(numThreads + 1);
+  std::vector<size_t> splitB(numThreads + 1);
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    splitA[t] = t * count / numThreads;
+    splitB[t] = (t == 0) ? 0 : gallop(other._ids, splitB[t - 1], other._ids.size(), _ids[splitA[t]]);
+  }
+  splitA[numThreads] = count;
+  splitB[numThreads] = other._ids.size();
+
+  std::vector<std::vector<std::pair<size_t, size_t>>> partial(numThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    threads.emplace_back([this, &other, &partial, &splitA, &splitB, t]() {
+      matchRange(other, splitA[t], splitA[t + 1], splitB[t], splitB[t + 1], false, [&partial, t](size_t posA, size_t posB) {
+        partial[t].push_back(std::make_pair(posA, posB));
+        return true;
+      });
+    });
+  }
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    threads[t].join();
+  }
+
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    for (size_t i = 0; i < partial[t].size(); i++)
+    {
+      size_t posA = partial[t][i].first;
+      if (callback(_ids[posA], _objects[posA], other._objects[partial[t][i].second]) == false)
+      {
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Returns a new store with the settings and indexes of this store, holding the entries 
+ *        of this store and copies of the entries of the other store with ids not existing in 
+ *        this store
+ * 
+ * @param other  the store to unite with
+ * @return spObjectStore<T>  the new store
+ */
+template <class T>
+spObjectStore<T> spObjectStore<T>::unionWith(spObjectStore<T> &other)
+{
+  spObjectStore<T> result(*this);
+  result.unionFrom(other, false);
+  return result;
+}
+
+/**
+ * @brief Returns a new store with the settings and indexes of this store, holding the entries 
+ *        of this store with ids also existing in the other store
+ * 
+ * @param other  the store to intersect with
+ * @return spObjectStore<T>  the new store
+ */
+template <class T> template <class U>
+spObjectStore<T> spObjectStore<T>::intersectWith(spObjectStore<U> &other)
+{
+  spObjectStore<T> result(*this);
+  result.retainFrom(other, true);
+  return result;
+}
+
+/**
+ * @brief Returns a new store with the settings and indexes of this store, holding the entries 
+ *        of this store with ids not existing in the other store
+ * 
+ * @param other  the store with the ids to remove
+ * @return spObjectStore<T>  the new store
+ */
+template <class T> template <class U>
+spObjectStore<T> spObjectStore<T>::differenceFrom(spObjectStore<U> &other)
+{
+  spObjectStore<T> result(*this);
+  result.retainFrom(other, false);
+  return result;
+}
+
+/**
+ * @brief Add copies of the other store's entries with ids not existing in this store
+ * 
+ * @param other  the store to unite with
+ */
+template <class T>
+void spObjectStore<T>::unionWithInPlace(spObjectStore<T> &other)
+{
+  static_assert(std::is_copy_constructible<T>::value, "unionWithInPlace() copies the objects, move the other store instead");
+  unionFrom(other, false);
+}
+
+/**
+ * @brief Move the other store's entries with ids not existing in this store into this store,
+ *        e.g. unionWithInPlace(std::move(otherStore)), which leaves the other store empty
+ * 
+ * @param other  the store to unite with
+ */
+template <class T>
+void spObjectStore<T>::unionWithInPlace(spObjectStore<T> &&other)
+{
+  unionFrom(other, true);
+  other.reset();
+}
+
+/**
+ * @brief Move the other store's entries for which predicate(id, obj) returns true into 
+ *        this store, replacing entries with the same ids, and return their number. The 
+ *        objects are moved, not copied, and stores sorted by ids in the same direction 
+ *        are merged in one pass. In a batch, the entries are staged as copies, so objects 
+ *        that cannot be copied are not moved
+ * 
+ * @param other  the store to take the entries from
+ * @param predicate  function of type bool func(const std::string &id, const class &obj)
+ * @return size_t  number of entries moved
+ */
+template <class T>
+size_t spObjectStore<T>::spliceFrom(spObjectStore<T> &other, spos_forEach_IO_callback predicate)
+{
+  if (this == &other)
+  {
+    return 0;
+  }
+  std::vector<std::string> ids;
+  std::vector<T> objects;
+  if (_batching || other._batching)
+  {
+    // staged one by one
+    other.forEach([&ids, &predicate](const std::string &id, const T &obj) {
+      if (predicate(id, obj))
+      {
+        ids.push_back(id);
+      }
+      return true;
+    });
+    // extract() returns empty nodes for objects that cannot be copied
+    size_t moved = 0;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      if (insert(other.extract(ids[i])) != nullptr)
+      {
+        moved++;
+      }
+    }
+    return moved;
+  }
+  other.normalize();
+  size_t count = other._ids.size();
+  std::vector<uint8_t> keep(count, 1);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (predicate(other._ids[i], other._objects[i]))
+    {
+      keep[i] = 0;
+      other.emitChange(ChangeErase, other._ids[i], nullptr);
+      ids.push_back(std::move(other._ids[i]));
+      objects.push_back(std::move(other._objects[i]));
+    }
+  }
+  size_t moved = ids.size();
+  if (moved == 0)
+  {
+    return 0;
+  }
+  other.compactEntries(keep);
+  other.rebuildIndexes();
+  // mergeEntries() may swap ids with the entries of this store
+  mergeEntries(ids, objects, hasSameIdOrder(other));
+  return moved;
+}
+
+/**
+ * @brief Move the entries from the given id on into a new store with the settings and 
+ *        indexes of this store and return it. For stores sorted by ids, these are the 
+ *        entries with ids not before id, which need not exist, otherwise the entry with 
+ *        this id and the ones after it. The entries are moved as one chunk. In a batch, 
+ *        the entries are staged as copies, so objects that cannot be copied are not moved 
+ *        and the new store is empty
+ * 
+ * @param id  id of the first entry to move
+ * @return spObjectStore<T>  the new store
+ */
+template <class T>
+spObjectStore<T> spObjectStore<T>::splitAt(const std::string &id)
+{
+  spObjectStore<T> result;
+  result.copySettings(*this);
+  // the cloned indexes still hold the entries of this store
+  result.rebuildIndexes();
+  normalize();
+  size_t count = _ids.size();
+  size_t first = isSortedById() ? gallop(_ids, 0, count, id) : std::find(_ids.begin(), _ids.end(), id) - _ids.begin();
+  if (_batching)
+  {
+    // staged one by one
+    std::vector<std::string> ids(_ids.begin() + first, _ids.end());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      result.insert(extract(ids[i]));
+    }
+    return result;
+  }
+  for (size_t i = first; i < count; i++)
+  {
+    emitChange(ChangeErase, _ids[i], nullptr);
+  }
+  result._ids.reserve(count - first + _capaInc);
+  result._objects.reserve(count - first + _capaInc);
+  result._ids.insert(result._ids.end(), std::make_move_iterator(_ids.begin() + first), std::make_move_iterator(_ids.end()));
+  result._objects.insert(result._objects.end(), std::make_move_iterator(_objects.begin() + first), std::make_move_iterator(_objects.end()));
+  _ids.erase(_ids.begin() + first, _ids.end());
+  _objects.erase(_objects.begin() + first, _objects.end());
+  rebuildIndexes();
+  for (size_t i = 0; i < result._ids.size(); i++)
+  {
+    result.emitChange(ChangeInsert, result._ids[i], &result._objects[i]);
+  }
+  result.rebuildIndexes();
+  return result;
+}
+
+/**
+ * @brief Move all entries of the other store into this store, replacing entries with the 
+ *        same ids, which leaves the other store empty. The objects are moved, not copied,
+ *        and stores sorted by ids in the same direction are merged in one pass or, if all 
+ *        ids of the other store come after the ones of this store, appended as one chunk
+ * 
+ * @param other  the store to take the entries from
+ */
+template <class T>
+void spObjectStore<T>::mergeFrom(spObjectStore<T> &other)
+{
+  if (this == &other)
+  {
+    return;
+  }
+  if (_batching || other._batching)
+  {
+    spliceFrom(other, [](const std::string &, const T &) { return true; });
+    return;
+  }
+  other.normalize();
+  std::vector<std::string> ids;
+  std::vector<T> objects;
+  ids.swap(other._ids);
+  objects.swap(other._objects);
+  other.reset();
+  mergeEntries(ids, objects, hasSameIdOrder(other));
+}
+
+/**
+ * @brief Delete all entries with ids not existing in the other store
+ * 
+ * @param other  the store to intersect with
+ */
+template <class T> template <class U>
+void spObjectStore<T>::intersectWithInPlace(spObjectStore<U> &other)
+{
+  retainFrom(other, true);
+}
+
+/**
+ * @brief Delete all entries with ids existing in the other store
+ * 
+ * @param other  the store with the ids to delete
+ */
+template <class T> template <class U>
+void spObjectStore<T>::differenceFromInPlace(spObjectStore<U> &other)
+{
+  retainFrom(other, false);
+}
+
+/**
+ * @brief Returns the number of ids existing in this or the other store
+ * 
+ * @param other  the store to compare with
+ * @return size_t number
+ */
+template <class T> template <class U>
+size_t spObjectStore<T>::countUnionWith(spObjectStore<U> &other)
+{
+  size_t count = countIntersectWith(other);
+  return getSize() + other.getSize() - count;
+}
+
+/**
+ * @brief Returns the number of ids existing in both this and the other store
+ * 
+ * @param other  the store to compare with
+ * @return size_t number
+ */
+template <class T> template <class U>
+size_t spObjectStore<T>::countIntersectWith(spObjectStore<U> &other)
+{
+  size_t count = 0;
+  matchAll(other, false, [&count](size_t /* posA */, size_t /* posB */) { count++; return true; });
+  return count;
+}
+
+/**
+ * @brief Returns the number of ids existing in this, but not in the other store
+ * 
+ * @param other  the store to compare with
+ * @return size_t number
+ */
+template <class T> template <class U>
+size_t spObjectStore<T>::countDifferenceFrom(spObjectStore<U> &other)
+{
+  size_t count = countIntersectWith(other);
+  return getSize() - count;
+}
+
+/**
+ * @brief Add a hash tree with the given name, which is used by diff() to compare this store 
+ *        with another one. The callback returns a hash of an object's values, which is 
+ *        combined with the object's id. The tree has 2^depth leaves, each covering a range 
+ *        of id hashes, and is kept in sync like other indexes, but needs touchObjById() after 
+ *        changes via object pointers. Returns false if an index with this name already exists
+ * 
+ * @param name  name of the hash tree
+ * @param callback  function of type uint64_t func(const class &obj)
+ * @param depth  number of levels below the root (1 .. 24), default 16
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::addHashTree(const std::string &name, typename spos_hash_tree<T>::spos_hash_callback callback, uint8_t depth)
+{
+  if ((findIndex(name) != nullptr) || (callback == nullptr) || (depth < 1) || (depth > 24))
+  {
+    return false;
+  }
+  spos_index<T> *index = new spos_hash_tree<T>(name, callback, depth);
+  compactDeleted();
+  index->onRebuild(_ids, _objects);
+  _indexes.emplace_back(index);
+  return true;
+}
+
+/**
+ * @brief Compare this store with the other one by their hash trees of the given name, which
+ *        must have the same depth and hash callback, and return the ids only in this store 
+ *        (added), only in the other store (removed) and in both, but with different object 
+ *        hashes (changed), i.e. the changes turning the other store into this one. Only 
+ *        ranges with different hashes are looked at. Returns false if the trees are missing 
+ *        or not of the same depth
+ * 
+ * @param name  name of the hash tree
+ * @param other  the store to compare with
+ * @param added  receives the ids only in this store
+ * @param removed  receives the ids only in the other store
+ * @param changed  receives the ids with different objects
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::diff(const std::string &name, spObjectStore<T> &other, std::vector<std::string> &added, std::vector<std::string> &removed, std::vector<std::string> &changed)
+{
+  spos_index<T> *mine = findIndex(name);
+  spos_index<T> *theirs = other.findIndex(name);
+  if ((mine == nullptr) || (theirs == nullptr) || 
+      (mine->_typeTag != spos_type_tag<spos_hash_tree<T>>()) || (theirs->_typeTag != mine->_typeTag))
+  {
+    return false;
+  }
+  spos_hash_tree<T> *myTree = static_cast<spos_hash_tree<T>*>(mine);
+  spos_hash_tree<T> *theirTree = static_cast<spos_hash_tree<T>*>(theirs);
+  if (myTree->_depth != theirTree->_depth)
+  {
+    return false;
+  }
+  myTree->diff(*theirTree, added, removed, changed);
+  return true;
+}
+
+/**
+ * @brief Set the callback to be invoked with each change of the store's entries, i.e. 
+ *        insert, replace (incl. touchObjById()), erase, reset and re-sort, or nullptr to 
+ *        stop. Each change has a sequence number, which increases by one per change
+ * 
+ * @param callback  function of type void func(const sposChange<class> &change)
+ */
+template <class T>
+void spObjectStore<T>::setChangeCallback(spos_change_callback callback)
+{
+  _changeCB = callback;
+}
+
+/**
+ * @brief Returns the sequence number of the last change of the store's entries
+ * 
+ * @return uint64_t sequence number
+ */
+template <class T>
+uint64_t spObjectStore<T>::getChangeSeq()
+{
+  return _changeSeq;
+}
+
+/**
+ * @brief Switch per-entry versions on or off. Each insert, replace and erase sets the 
+ *        entry's version to the sequence number of that change and deletes are kept 
+ *        as tombstones. Entries already stored get the current sequence number
+ * 
+ * @param versioning  true / false
+ */
+template <class T>
+void spObjectStore<T>::setVersioning(bool versioning)
+{
+  _versions.clear();
+  _versionLog.clear();
+  _versioning = versioning;
+  if (!_versioning)
+  {
+    return;
+  }
+  _versions.reserve(_ids.size());
+  _versionLog.reserve(_ids.size());
+  for (size_t i = 0; i < _ids.size(); i++)
+  {
+    _versions[_ids[i]] = std::make_pair(_changeSeq, false);
+    _versionLog.emplace_back(_changeSeq, _ids[i]);
+  }
+}
+
+/**
+ * @brief Returns whether per-entry versions are kept
+ * 
+ * @return true / false
+ */
+template <class T>
+bool spObjectStore<T>::isVersioning()
+{
+  return _versioning;
+}
+
+/**
+ * @brief Returns the version of the object with this id or 0 if no such object is 
+ *        stored or versions are not kept
+ * 
+ * @param id  id of the object
+ * @return uint64_t version
+ */
+template <class T>
+uint64_t spObjectStore<T>::getVersionById(const std::string &id)
+{
+  auto it = _versions.find(id);
+  if ((it == _versions.end()) || it->second.second)
+  {
+    return 0;
+  }
+  return it->second.first;
+}
+
+/**
+ * @brief Loop through the entries changed after the given version in the order of 
+ *        their versions and call callback(id, obj, version), with obj being a nullptr 
+ *        for deleted entries (tombstones). Only the latest version of each entry is 
+ *        reported. Stops when the callback returns false. The changes are found with 
+ *        a version ordered log and only the changed entries are looked up, which is a 
+ *        binary search in stores sorted by ids and a search through the ids otherwise
+ * 
+ * @param version  version already known by the caller, e.g. getChangeSeq() of an earlier call
+ * @param callback  function of type bool func(const std::string &id, const class *obj, uint64_t version)
+ */
+template <class T>
+void spObjectStore<T>::forEachChangedSince(uint64_t version, spos_changed_callback callback)
+{
+  auto it = std::upper_bound(_versionLog.begin(), _versionLog.end(), version, 
+                             [](uint64_t v, const std::pair<uint64_t, std::string> &entry) { return v < entry.first; });
+  if (it == _versionLog.end())
+  {
+    return;
+  }
+  for (; it != _versionLog.end(); ++it)
+  {
+    auto state = _versions.find(it->second);
+    if ((state == _versions.end()) || (state->second.first != it->first))
+    {
+      // newer version later in the log or purged tombstone
+      continue;
+    }
+    const T *obj = nullptr;
+    if (!state->second.second)
+    {
+      int32_t pos = indexOf(it->second, nullptr);
+      obj = (pos > -1) ? &_objects[pos] : nullptr;
+    }
+    if (!callback(it->second, obj, it->first))
+    {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Remove the tombstones of entries deleted up to the given version, e.g. once all 
+ *        consumers have seen this version
+ * 
+ * @param version  latest version to purge
+ * @return size_t  number of tombstones removed
+ */
+template <class T>
+size_t spObjectStore<T>::purgeTombstones(uint64_t version)
+{
+  size_t count = 0;
+  for (auto it = _versions.begin(); it != _versions.end();)
+  {
+    if (it->second.second && (it->second.first <= version))
+    {
+      it = _versions.erase(it);
+      count++;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Start a batch: adding, setting and deleting objects and reset() are staged until 
+ *        commit() applies them all at once or rollback() discards them. Until then all 
+ *        other functions see the store without the staged changes
+ * 
+ */
+template <class T>
+void spObjectStore<T>::beginBatch()
+{
+  _batch.clear();
+  _batchIds.clear();
+  _batchReset = false;
+  _batching = true;
+}
+
+/**
+ * @brief Returns whether changes are staged for a batch
+ * 
+ * @return true / false
+ */
+template <class T>
+bool spObjectStore<T>::isBatching()
+{
+  return _batching;
+}
+
+/**
+ * @brief Apply all changes staged since beginBatch() in one pass, i.e. with one re-sort 
+ *        and one index rebuild, and end the batch
+ * 
+ */
+template <class T>
+void spObjectStore<T>::commit()
+{
+  if (!_batching)
+  {
+    return;
+  }
+  std::vector<sposChange<T>> batch;
+  batch.swap(_batch);
+  _batchIds.clear();
+  _batchReset = false;
+  _batching = false;
+  // the staged objects belong to the batch only and are moved into the store
+  applyChanges(batch, true);
+}
+
+/**
+ * @brief Discard all changes staged since beginBatch() and end the batch
+ * 
+ */
+template <class T>
+void spObjectStore<T>::rollback()
+{
+  _batch.clear();
+  _batchIds.clear();
+  _batchReset = false;
+  _batching = false;
+}
+
+/**
+ * @brief Set the minimum size of the write buffer for stores sorted by ids (0 = off, 
+ *        default). New entries are then appended to an unsorted buffer, which is sorted and 
+ *        merged with the other entries in one pass, when it holds size entries or 1/16 of 
+ *        all entries, whichever is more. This makes random inserts into large stores 
+ *        O(log n) amortized instead of O(n). Entries are still found by their ids and 
+ *        iterated in order, functions using positions merge the buffer first
+ * 
+ * @param size  minimum number of entries buffered before merging, 0 to merge and stop
+ */
+template <class T>
+void spObjectStore<T>::setWriteBuffer(size_t size)
+{
+  _writeBuffer = size;
+  if ((size == 0) && !_lazySorting)
+  {
+    mergeWriteBuffer();
+  }
+}
+
+/**
+ * @brief Returns the minimum size of the write buffer, 0 if not buffering
+ * 
+ * @return size_t 
+ */
+template <class T>
+size_t spObjectStore<T>::getWriteBuffer()
+{
+  return _writeBuffer;
+}
+
+/**
+ * @brief Set lazy sorting for stores sorted by ids (default false). New entries are then 
+ *        appended to the write buffer (see setWriteBuffer()) without limit and sorted in 
+ *        one pass by the first function needing the order, e.g. forEach(), a query or 
+ *        getObjAt(). Meanwhile entries are found by their ids with a hash index of the 
+ *        buffer. Setting it to false sorts immediately
+ * 
+ * @param lazy  true to defer sorting
+ */
+template <class T>
+void spObjectStore<T>::setLazySorting(bool lazy)
+{
+  _lazySorting = lazy;
+  if (!lazy)
+  {
+    mergeWriteBuffer();
+  }
+}
+
+/**
+ * @brief Returns true if sorting is deferred
+ * 
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::isLazySorting()
+{
+  return _lazySorting;
+}
+
+/**
+ * @brief Set deferred deletes (0 = off, default). Deleted entries are then only marked, 
+ *        skipped by all functions, and removed in one pass, when they exceed the given 
+ *        fraction of all entries or compactDeleted() is called. Adding a deleted id again 
+ *        reuses its entry. This makes deletes O(log n) amortized instead of O(n). Stores 
+ *        with indexes or a compare callback always delete immediately
+ * 
+ * @param fraction  fraction of deleted entries triggering compaction, e.g. 0.25
+ */
+template <class T>
+void spObjectStore<T>::setDeferredDeletes(double fraction)
+{
+  _deferredDeletes = fraction;
+  if (fraction <= 0)
+  {
+    compactDeleted();
+  }
+}
+
+/**
+ * @brief Returns the fraction of deleted entries triggering compaction, 0 if deleting immediately
+ * 
+ * @return double 
+ */
+template <class T>
+double spObjectStore<T>::getDeferredDeletes()
+{
+  return _deferredDeletes;
+}
+
+/**
+ * @brief Returns the number of deleted entries not removed yet
+ * 
+ * @return size_t 
+ */
+template <class T>
+size_t spObjectStore<T>::getDeletedCount()
+{
+  return _deletedCount;
+}
+
+/**
+ * @brief Remove all deleted entries marked by deferred deletes in one pass
+ * 
+ */
+template <class T>
+void spObjectStore<T>::compactDeleted()
+{
+  if (_deletedCount == 0)
+  {
+    return;
+  }
+  std::vector<uint8_t> keep(_dead.size());
+  size_t tailStart = 0;
+  for (size_t i = 0; i < keep.size(); i++)
+  {
+    keep[i] = _dead[i] ? 0 : 1;
+    if ((i < _tailStart) && keep[i])
+    {
+      tailStart++;
+    }
+  }
+  compactEntries(keep);
+  _dead.clear();
+  _deletedCount = 0;
+  if (!_tailIds.empty())
+  {
+    _tailStart = tailStart;
+    _tailIds.clear();
+    for (size_t i = _tailStart; i < _ids.size(); i++)
+    {
+      _tailIds[_ids[i]] = i;
+    }
+  }
+  rebuildIndexes();
+}
+
+/**
+ * @brief Sort the entries in the write buffer and merge them with the other entries in 
+ *        one pass
+ * 
+ */
+template <class T>
+void spObjectStore<T>::mergeWriteBuffer()
+{
+  if (_tailIds.empty())
+  {
+    return;
+  }
+  compactDeleted();
+  std::vector<size_t> tail = tailOrder();
+  std::vector<std::string> ids;
+  std::vector<T> objects;
+  ids.reserve(_ids.capacity());
+  objects.reserve(_objects.capacity());
+  size_t posA = 0;
+  size_t posB = 0;
+  while ((posA < _tailStart) || (posB < tail.size()))
+  {
+    size_t pos;
+    if ((posB >= tail.size()) || ((posA < _tailStart) && (compareIds(_ids[posA], _ids[tail[posB]]) < 0)))
+    {
+      pos = posA++;
+    }
+    else
+    {
+      pos = tail[posB++];
+    }
+    ids.push_back(std::move(_ids[pos]));
+    objects.push_back(std::move(_objects[pos]));
+  }
+  _ids.swap(ids);
+  _objects.swap(objects);
+  _tailIds.clear();
+  rebuildIndexes();
+}
+
+/**
+ * @brief Apply changes reported by another store's change feed, e.g. to keep a follower 
+ *        store in sync. Only the last change per id is applied and a reset drops all 
+ *        changes before it. Re-sorts are ignored, as the store keeps its own sorting. 
+ *        A large batch is merged into the store in one pass
+ * 
+ * @param changes  changes in the order of their sequence numbers
+ */
+template <class T>
+void spObjectStore<T>::applyChanges(const std::vector<sposChange<T>> &changes)
+{
+  static_assert(std::is_copy_constructible<T>::value, "applyChanges() copies the objects of the changes");
+  applyChanges(changes, false);
+}
+
+/**
+ * @brief Apply changes like applyChanges(), either copying their objects or, for changes 
+ *        owned by the store only like a committed batch, moving them
+ * 
+ * @param changes  changes in the order of their sequence numbers
+ * @param moveObjs  true to move the objects of the changes
+ */
+template <class T>
+void spObjectStore<T>::applyChanges(const std::vector<sposChange<T>> &changes, bool moveObjs)
+{
+  // only changes after the last reset matter
+  size_t first = 0;
+  for (size_t i = changes.size(); i > 0; i--)
+  {
+    if (changes[i - 1].op == ChangeReset)
+    {
+      first = i;
+      reset();
+      break;
+    }
+  }
+
+  // last change per id
+  std::unordered_map<std::string, size_t> lastChange;
+  std::vector<size_t> order;
+  for (size_t i = first; i < changes.size(); i++)
+  {
+    if (changes[i].op == ChangeResort)
+    {
+      continue;
+    }
+    auto it = lastChange.find(changes[i].id);
+    if (it == lastChange.end())
+    {
+      lastChange[changes[i].id] = order.size();
+      order.push_back(i);
+    }
+    else
+    {
+      order[it->second] = i;
+    }
+  }
+
+  // setObjWithId() finds existing entries by their new values with a compare callback
+  if ((_compareCB == nullptr) && ((order.size() < 16) || (order.size() < _ids.size() / 16)))
+  {
+    // one by one
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      const sposChange<T> &change = changes[order[i]];
+      if (change.op == ChangeErase)
+      {
+        deleteObjById(change.id);
+      }
+      else if (change.obj != nullptr)
+      {
+        setObjWithId(change.id, takeObj(*change.obj, moveObjs));
+      }
+    }
+    return;
+  }
+
+  mergeChanges(changes, order, moveObjs);
+}
+
+/**
+ * @brief Returns a pointer to the object at the given position (0 .. getSize() - 1) or 
+ *        a nullptr if the position is out of range
+ * 
+ * @param pos  position in the store
+ * @return T* pointer to object stored
+ */
+template <class T>
+T* spObjectStore<T>::getObjAt(size_t pos)
+{
+  normalize();
+  if (pos >= _objects.size())
+  {
+    return nullptr;
+  }
+  return &_objects[pos];
+}
+
+/**
+ * @brief Returns the id of the object at the given position (0 .. getSize() - 1) or 
+ *        an empty string if the position is out of range
+ * 
+ * @param pos  position in the store
+ * @return std::string  the id of the object stored
+ */
+template <class T>
+std::string spObjectStore<T>::getIdAt(size_t pos)
+{
+  normalize();
+  if (pos >= _ids.size())
+  {
+    return "";
+  }
+  return _ids[pos];
+}
+
+
+/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
+
+      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
+      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx      
+      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx      
+      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx    
+      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx    
+      xx        xx    xx     xx       xxxx    xx    xx     xx     xx      
+      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
+     
+
+      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+
+
+
+/**
+ * @brief Return the result of comparing of two ids in dependence of None, ASC or DESC 
+ * 
+ * @param id1 
+ * @param id2 
+ * @return int32_t 
+ */
+template <class T>
+int32_t spObjectStore<T>::compareIds(const std::string &id1, const std::string &id2)
+{
+  int32_t cmpRes = strcmp(id1.c_str(), id2.c_str());
+  if (_sorting == DESC)
+  {
+    cmpRes *= -1;
+  }
+  return cmpRes;
+}
+
+/**
+ * @brief Get the index (=_index) for an object's id and/or object.
+ *        Returns -1 if it does not exist (_index is then the position to insert new entry, 
+ *        which is the slot of a deleted entry with this id, if any)
+ * 
+ * @param id 
+ * @return int32_t index 
+ */
+template <class T>
+int32_t spObjectStore<T>::indexOf(const std::string &id, const T *obj)
+{
+  int32_t pos = locate(id, obj);
+  if ((pos > -1) && (_deletedCount > 0) && _dead[pos])
+  {
+    return -1;
+  }
+  return pos;
+}
+
+/**
+ * @brief Get the index (=_index) for an object's id and/or object, including deleted 
+ *        entries not compacted yet. Returns -1 if it does not exist
+ * 
+ * @param id 
+ * @return int32_t index 
+ */
+template <class T>
+int32_t spObjectStore<T>::locate(const std::string &id, const T *obj)
+{
+  size_t count = _ids.size();
+  // we already worked on it?
+  if ((_index > -1) && (_index < count) && (_ids[_index] == id)){
+    return _index;
+  }
+  // write buffer first, then the sorted entries before it, new ones are appended to it
+  if (!_tailIds.empty())
+  {
+    auto it = _tailIds.find(id);
+    if (it != _tailIds.end())
+    {
+      _index = it->second;
+      return _index;
+    }
+    count = _tailStart;
+  }
+  if (isSorted()){
+    // let's find it with lower bound implementation
+    uint32_t step;
+    uint32_t first = 0;
+    uint32_t sIdx;
+    int32_t cmpRes;
+    
+    while (count > 0){
+      sIdx = first;
+      step = count / 2;
+      sIdx += step;
+      //cmpRes of <0 = A has lower value, 0 = same, >0 = A has higher value
+      if ((_compareCB == nullptr) || (obj == nullptr)){
+        cmpRes = compareIds(_ids[sIdx].c_str(), id.c_str());
+      } else {
+        cmpRes = _compareCB(_objects[sIdx], *obj);
+        // when looking at same obj values, i.e. xmpRes = 0, we need to check ids, except id == ""
+        if ((cmpRes == 0) && (id.length() > 0))
+        {
+          cmpRes = compareIds(_ids[sIdx].c_str(), id.c_str());
+        }
+      }
+      
+      if (cmpRes < 0){
+          first = ++sIdx;
+          count -= step + 1;
+      } else if(cmpRes == 0) {
+        _index = sIdx;
+        return _index;
+      } else {
+        count = step;
+      }
+    }
+    _index = isBuffering() ? _ids.size() : first;
+    return -1;
+
+  } else {
+    // not sorted, let's find it by looping from 0 to n
+    for (_index = 0; _index < count; _index++) {
+      if (_ids[_index] == id) {
+        return _index;
+      }
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Set capacity to new increased value
+ * 
+ * @param capacity  new size
+ */
+template <class T>
+void spObjectStore<T>::setCapacity(size_t capacity)
+{
+  if (capacity > _ids.capacity())
+  {
+    _ids.reserve(capacity);
+    _objects.reserve(capacity);
+  }  
+}
+
+
+/**
+ * @brief Set _added status and, if needed, expand the vectors' capacity
+ * 
+ * @param added 
+ */
+template <class T>
+void spObjectStore<T>::setAdded(bool added)
+{
+  // if already false, return
+  if (!added && !_added){
+    return;
+  }
+  // otherwise set and check capa
+  _added = added;
+  size_t count = _ids.size();
+  if (added && (count + 2  > _ids.capacity())){
+    setCapacity(count + _capaInc);
+  }
+}
+
+/**
+ * @brief Returns the formatted string representation of value.
+ *        Overloaded function for all types and formatted with default sizes
+ * 
+ * @param value 
+ * @return std::string 
+ */
+template <class T>
+std::string spObjectStore<T>::stringify(const uint64_t &value)
+{
+  char buf[100];
+  snprintf(buf, 100, "%0*llu", 8, value);
+  return std::string(buf);
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const uint32_t &value)
+{
+  return stringify(static_cast<uint64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const uint16_t &value)
+{
+  return stringify(static_cast<uint64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const uint8_t &value)
+{
+  return stringify(static_cast<uint64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const int64_t &value)
+{
+  char buf[100];
+  snprintf(buf, 100, "%0*lld", _idNumDigits, value);
+  return std::string(buf);
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const int32_t &value)
+{
+  return stringify(static_cast<int64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const int16_t &value)
+{
+  return stringify(static_cast<int64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const int8_t &value)
+{
+  return stringify(static_cast<int64_t>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const long double &value)
+{
+  char buf[100];
+  snprintf(buf, 100, "%+0*.*LF", _idNumSize, _idNumDecimals, value);
+  return std::string(buf);
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const double &value)
+{
+  return stringify(static_cast<long double>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const float &value)
+{
+  return stringify(static_cast<long double>(value));
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const std::string &value)
+{
+  return std::string(value);
+}
+template <class T>
+std::string spObjectStore<T>::stringify(const char &value)
+{
+  return std::string(1, value);
+}
+
+/**
+ * @brief Make an id from variadic arguments, joined together with separator.
+ *        Overloaded function for no, one and many arguments
+ * 
+ * @return std::string 
+ */
+// do nothing func
+template <class T>
+std::string spObjectStore<T>::makeIdFrom()
+{
+  return "";
+}
+// one arg
+template <class T> template<class U>
+std::string spObjectStore<T>::makeIdFrom(U arg)
+{
+  //return spos_stringify(arg);
+  return stringify(arg);
+}
+// many args
+template<class T> template<class U, class... Vs>
+std::string spObjectStore<T>::makeIdFrom(U arg, Vs... args)
+{
+  //std::string res = spos_stringify(arg);
+  std::string res = stringify(arg);
+  res.append(_idSep);
+  return res.append(makeIdFrom(args...));
+}
+
+/**
+ * @brief  Returns an id created either by _createIdCB() or _autoId 
+ * 
+ * @param obj 
+ * @return std::string 
+ */
+template <class T>
+std::string spObjectStore<T>::createId(const T &obj)
+{
+  if (_createIdCB != nullptr)
+  {
+    return _createIdCB(obj);
+  }
+  else
+  {
+    return makeIdFrom(_autoId++);
+  }
+}
+
+
+/**
+ * @brief Recreate the vectors (if there are entries) based on sorting choosen,
+ *        either with preserved ids or newly created ones 
+ * 
+ * @param preserveIds  true to keep the ids
+ */
+template <class T>
+void spObjectStore<T>::recreate(bool preserveIds)
+{
+  compactDeleted();
+  size_t count = _ids.size();
+  if (count > 0)
+  {
+    if (preserveIds)
+    {
+      // same entries in a new order, sort them in one pass, including the write buffer
+      _tailIds.clear();
+      if (isSorted())
+      {
+        sortEntries();
+      }
+      rebuildIndexes();
+      emitChange(ChangeResort, "", nullptr);
+      return;
+    }
+    std::vector<T> old_objects(std::move(_objects));
+    reset();
+    setCapacity(count + _capaInc);
+    for (size_t i = 0; i < count; i++)
+    {
+      std::string id = createId(old_objects[i]);
+      setObjWithId(id, std::move(old_objects[i]));
+    }
+  }
+}
+
+/**
+ * @brief Returns whether the entry at posA ranks before the one at posB when selecting
+ *        the highest (largest = true) or lowest values. Ties are decided by position
+ * 
+ * @param callback  compare function
+ * @param largest  true when selecting highest values
+ * @param posA 
+ * @param posB 
+ * @return true / false 
+ */
+template <class T>
+bool spObjectStore<T>::isBetter(const spos_compare_callback &callback, bool largest, size_t posA, size_t posB)
+{
+  int cmpRes = callback(_objects[posA], _objects[posB]);
+  if (cmpRes == 0)
+  {
+    return posA < posB;
+  }
+  return largest ? (cmpRes > 0) : (cmpRes < 0);
+}
+
+/**
+ * @brief Returns the positions of the k best entries within [first, last), best first.
+ *        Uses a bounded heap with the worst selected entry on top. Deleted entries not
+ *        removed yet are skipped, so the store is not compacted and pointers stay valid
+ * 
+ * @param k  number of entries to select
+ * @param callback  compare function
+ * @param largest  true when selecting highest values
+ * @param first  first position to consider
+ * @param last  position after the last one to consider
+ * @return std::vector<size_t> 
+ */
+template <class T>
+std::vector<size_t> spObjectStore<T>::selectK(size_t k, const spos_compare_callback &callback, bool largest, size_t first, size_t last)
+{
+  std::vector<size_t> heap;
+  if ((k == 0) || (callback == nullptr) || (first >= last))
+  {
+    return heap;
+  }
+  auto better = [this, &callback, largest](size_t a, size_t b) { return isBetter(callback, largest, a, b); };
+  heap.reserve(std::min(k, last - first));
+  for (size_t i = first; i < last; i++)
+  {
+    if ((_deletedCount > 0) && _dead[i])
+    {
+      continue;
+    }
+    if (heap.size() < k)
+    {
+      heap.push_back(i);
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+    else if (better(i, heap.front()))
+    {
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = i;
+      std::push_heap(heap.begin(), heap.end(), better);
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+  return heap;
+}
+
+/**
+ * @brief Returns the positions of the k best entries, best first, with the entries
+ *        partitioned into ranges selected by separate threads and merged afterwards
+ * 
+ * @param k  number of entries to select
+ * @param callback  compare function
+ * @param largest  true when selecting highest values
+ * @param numThreads  number of threads to use, 0 for the number of hardware threads
+ * @return std::vector<size_t> 
+ */
+template <class T>
+std::vector<size_t> spObjectStore<T>::selectKParallel(size_t k, const spos_compare_callback &callback, bool largest, size_t numThreads)
+{
+  size_t count = _objects.size();
+  if (numThreads == 0)
+  {
+    numThreads = std::thread::hardware_concurrency();
+  }
+  // not worth starting threads for small ranges
+  numThreads = std::min(numThreads, count / 1024);
+  if (numThreads < 2)
+  {
+    return selectK(k, callback, largest, 0, count);
+  }
+
+  std::vector<std::vector<size_t>> partial(numThreads);
+  std::vector<std::thread> threads;
+  size_t chunk = (count + numThreads - 1) / numThreads;
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    size_t first = t * chunk;
+    size_t last = std::min(count, first + chunk);
+    threads.emplace_back([this, &partial, &callback, k, largest, t, first, last]() {
+      partial[t] = selectK(k, callback, largest, first, last);
+    });
+  }
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    threads[t].join();
+  }
+
+  // merge the per thread candidates
+  size_t total = 0;
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    total += partial[t].size();
+  }
+  std::vector<size_t> merged;
+  merged.reserve(total);
+  for (size_t t = 0; t < numThreads; t++)
+  {
+    merged.insert(merged.end(), partial[t].begin(), partial[t].end());
+  }
+  auto better = [this, &callback, largest](size_t a, size_t b) { return isBetter(callback, largest, a, b); };
+  if (merged.size() > k)
+  {
+    std::partial_sort(merged.begin(), merged.begin() + k, merged.end(), better);
+    merged.resize(k);
+  }
+  else
+  {
+    std::sort(merged.begin(), merged.end(), better);
+  }
+  return merged;
+}
+
+/**
+ * @brief Insert a new entry at pos and update indexes
+ * 
+ * @param pos  position of the new entry
+ * @param id  id of the new entry
+ * @param args  arguments to construct T
+ */
+template <class T> template <class... Vs>
+void spObjectStore<T>::insertAt(size_t pos, const std::string &id, Vs&&... args)
+{
+  if ((_deletedCount > 0) && (pos < _ids.size()) && _dead[pos] && (_ids[pos] == id))
+  {
+    // reuse the slot of the deleted entry
+    _objects[pos] = T(std::forward<Vs>(args)...);
+    _dead[pos] = 0;
+    if (--_deletedCount == 0)
+    {
+      _dead.clear();
+    }
+    emitChange(ChangeInsert, _ids[pos], &_objects[pos]);
+    return;
+  }
+  if (isBuffering() && (pos == _ids.size()))
+  {
+    // append to the write buffer, which grows with the store or, if lazy, until read in order
+    if (!_lazySorting && (_tailIds.size() >= std::max(_writeBuffer, _tailStart / 16)))
+    {
+      // compacting may have removed entries, new one is still appended
+      mergeWriteBuffer();
+      pos = _ids.size();
+      _index = pos;
+    }
+    if (_tailIds.empty())
+    {
+      _tailStart = pos;
+    }
+    _tailIds[id] = pos;
+  }
+  if (_deletedCount > 0)
+  {
+    _dead.insert(_dead.begin() + pos, 0);
+  }
+  _ids.insert(_ids.begin() + pos, id);
+  _objects.emplace(_objects.begin() + pos, std::forward<Vs>(args)...);
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onInsert(pos, _ids[pos], _objects[pos]);
+  }
+  emitChange(ChangeInsert, _ids[pos], &_objects[pos]);
+}
+
+/**
+ * @brief Erase the entry at pos and update indexes
+ * 
+ * @param pos  position of the entry
+ * @param taken  if not nullptr, the object is moved there instead of being destroyed
+ */
+template <class T>
+void spObjectStore<T>::eraseAt(size_t pos, spos_optional<T> *taken)
+{
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onErase(pos, _ids[pos], _objects[pos]);
+  }
+  emitChange(ChangeErase, _ids[pos], nullptr);
+  if (!_tailIds.empty())
+  {
+    if (pos >= _tailStart)
+    {
+      _tailIds.erase(_ids[pos]);
+    }
+    else
+    {
+      _tailStart--;
+    }
+    for (auto &entry : _tailIds)
+    {
+      if (entry.second > pos)
+      {
+        entry.second--;
+      }
+    }
+  }
+  if (_deletedCount > 0)
+  {
+    _dead.erase(_dead.begin() + pos);
+  }
+  if (taken != nullptr)
+  {
+    // indexes have seen the object, so it can be moved out now
+    taken->emplace(std::move(_objects[pos]));
+  }
+  _ids.erase(_ids.begin() + pos);
+  _objects.erase(_objects.begin() + pos);
+}
 
 /**
- * constructor - plain vanilla = no sorting
+ * @brief Delete the entry at pos, either by erasing it or, with deferred deletes, by 
+ *        marking it as deleted, which is compacted when there are too many
+ * 
+ * @param pos  position of the entry
  */
 template <class T>
-spObjectStore<T>::spObjectStore()
+void spObjectStore<T>::deleteAt(size_t pos)
 {
-  _sorting = None;
+  // indexes and compare callbacks need entries at their positions
+  if ((_deferredDeletes <= 0) || !_indexes.empty() || (_compareCB != nullptr))
+  {
+    eraseAt(pos);
+    return;
+  }
+  emitChange(ChangeErase, _ids[pos], nullptr);
+  if (_deletedCount == 0)
+  {
+    _dead.assign(_ids.size(), 0);
+  }
+  _dead[pos] = 1;
+  _deletedCount++;
+  if (_deletedCount > _deferredDeletes * _ids.size())
+  {
+    compactDeleted();
+  }
 }
 
 /**
- * constructor - sorting as None, ASC or DESC
+ * @brief Remove deleted entries and merge the write buffer, used before working on positions
+ * 
  */
 template <class T>
-spObjectStore<T>::spObjectStore(sposSort sorting)
+void spObjectStore<T>::normalize()
 {
-  _sorting = sorting;
+  compactDeleted();
+  mergeWriteBuffer();
 }
 
 /**
- * constructor - sorting by comparison callback
+ * @brief Update indexes after the object at pos was replaced or changed
+ * 
+ * @param pos  position of the entry
  */
 template <class T>
-spObjectStore<T>::spObjectStore(spos_compare_callback callback)
+void spObjectStore<T>::notifyReplaced(size_t pos)
 {
-  _sorting = None;
-  _compareCB = callback;
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onReplace(pos, _ids[pos], _objects[pos]);
+  }
+  emitChange(ChangeReplace, _ids[pos], &_objects[pos]);
 }
 
 /**
- * @brief Create an object, add it with the given id and return a pointer to it.
- *        If an object with this id already exists, then a new object is 
- *        stored under this id.
+ * @brief Returns the index with the given name or nullptr
  * 
- * @param id  id of the object to store
- * @param args optional arguments to construct T
- * @return T* pointer to object stored
+ * @param name  name of the index
+ * @return spos_index<T>* 
  */
-template<class T> template<class... Vs>
-T* spObjectStore<T>::addObjWithId(const std::string &id, Vs... args)
+template <class T>
+spos_index<T>* spObjectStore<T>::findIndex(const std::string &name)
 {
-  if (indexOf(id, nullptr) == -1){
-    setAdded(true);
-    _ids.insert(_ids.begin() + _index, id);
-    _objects.emplace(_objects.begin() + _index, args...);
-  } else {
-    setAdded(false);
-    _objects[_index] = T(args...);
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    if (_indexes[i]->_name == name)
+    {
+      return _indexes[i].get();
+    }
   }
-  return &_objects[_index];
+  return nullptr;
 }
 
 /**
- * @brief Create an object, add it with an autocreated id and return a pointer to it.
+ * @brief Returns the projection with the given name and value type U or nullptr
  * 
- * @param args optional arguments to construct T
- * @return T* pointer to object stored
+ * @param name  name of the projection
+ * @return spos_projection<T, U>* 
  */
-template<class T> template<class... Vs>
-T* spObjectStore<T>::addObjFromArgs(Vs ...args)
+template <class T> template <class U>
+spos_projection<T, U>* spObjectStore<T>::findProjection(const std::string &name)
 {
-  T newObj = T(args...);
-  std::string id = createId(newObj);
-  // must be index of -1
-  if (indexOf(id, &newObj) == -1){
-    setAdded(true);
-    _ids.insert(_ids.begin() + _index, id);
-    _objects.insert(_objects.begin() + _index, newObj);
-    return &_objects[_index];
+  spos_index<T> *index = findIndex(name);
+  if ((index == nullptr) || (index->_typeTag != spos_type_tag<spos_projection<T, U>>()))
+  {
+    return nullptr;
   }
-  return nullptr;
+  return static_cast<spos_projection<T, U>*>(index);
 }
 
 /**
- * @brief Set a copy(!) of an object with the given id, which is either replacing 
- *        an existing one or adding a new id - object pair. This is similar to 
- *        addObjWithId() but using an object instead of args to create the stored object
+ * @brief Returns the spatial index with the given name or nullptr
  * 
- * @param id  id of the object to store
- * @param newObj an object of class T, based on which a copy is created and stored
+ * @param name  name of the index
+ * @return spos_spatial_index<T>* 
  */
 template <class T>
-T* spObjectStore<T>::setObjWithId(const std::string &id, T &newObj)
+spos_spatial_index<T>* spObjectStore<T>::findSpatialIndex(const std::string &name)
 {
-  if (indexOf(id, &newObj) == -1){
-    setAdded(true);
-    _ids.insert(_ids.begin() + _index, id);
-    _objects.insert(_objects.begin() + _index, newObj);
-
-  } else {
-    setAdded(false);
-    _objects[_index] = newObj;
+  spos_index<T> *index = findIndex(name);
+  if ((index == nullptr) || (index->_typeTag != spos_type_tag<spos_spatial_index<T>>()))
+  {
+    return nullptr;
   }
-  return &_objects[_index];
+  return static_cast<spos_spatial_index<T>*>(index);
 }
 
 /**
- * @brief Get an object with the given id and return a pointer to it.
- *        If no object with this id exists, a nullptr is returned
+ * @brief Returns whether the entries are sorted by their ids, i.e. ASC or DESC without
+ *        compare callback
  * 
- * @param id  id of the object to find
- * @return T* pointer to object stored 
+ * @return true / false 
  */
-template<class T>
-T* spObjectStore<T>::getObjById(const std::string &id)
+template <class T>
+bool spObjectStore<T>::isSortedById()
 {
-  if (indexOf(id, nullptr) > -1){
-    return &_objects[_index];
-  }
-  return nullptr;
+  return (_compareCB == nullptr) && (_sorting != None);
 }
 
 /**
- * @brief Get an object with the given object arguments and return a pointer to it.
- *        If no object with these arguments exists, a nullptr is returned
+ * @brief Get the range of positions [first, last) with ids matching op and id. Only 
+ *        to be used when isSortedById() and op is not NotEqual
  * 
- * @param args arguments used when object was constructed 
- * @return T* pointer to object stored 
+ * @param op  comparison operator
+ * @param id  id to compare with
+ * @param first  first position
+ * @param last  position after the last one
  */
-template<class T> template<class... Vs>
-T* spObjectStore<T>::getObjFromArgs(Vs... args)
+template <class T>
+void spObjectStore<T>::idRange(sposOp op, const std::string &id, size_t &first, size_t &last)
 {
-  T obj = T(args...);
-  if (indexOf("", &obj) > -1){
-    return &_objects[_index];
+  // in sorting order, ids are either before, equal to or after id
+  size_t before = std::partition_point(_ids.begin(), _ids.end(), 
+                                       [this, &id](const std::string &e) { return compareIds(e, id) < 0; }) - _ids.begin();
+  size_t after = std::partition_point(_ids.begin() + before, _ids.end(), 
+                                      [this, &id](const std::string &e) { return compareIds(e, id) <= 0; }) - _ids.begin();
+  size_t count = _ids.size();
+  bool asc = (_sorting == ASC);
+  switch (op)
+  {
+    case Equal:         first = before; last = after; break;
+    case Less:          first = asc ? 0 : after; last = asc ? before : count; break;
+    case LessEqual:     first = asc ? 0 : before; last = asc ? after : count; break;
+    case Greater:       first = asc ? after : 0; last = asc ? count : before; break;
+    case GreaterEqual:  first = asc ? before : 0; last = asc ? count : after; break;
+    default:            first = 0; last = count; break;
   }
-  return nullptr;
 }
 
 /**
- * @brief Get the id of the object with the given arguments.
- *        If no object with these arguments exists, an empty string is returned
+ * @brief Returns whether this and the other store are both sorted by ids in the same direction
  * 
- * @param args arguments used when object was constructed 
- * @return std::string  the id of the object stored
+ * @param other 
+ * @return true / false 
  */
-template<class T> template<class... Vs>
-std::string spObjectStore<T>::getIdFromArgs(Vs... args)
+template <class T> template <class U>
+bool spObjectStore<T>::hasSameIdOrder(spObjectStore<U> &other)
 {
-  T obj = T(args...);
-  if (indexOf("", &obj) > -1){
-    return _ids[_index];
-  }
-  return "";
+  return isSortedById() && other.isSortedById() && (_sorting == other._sorting);
 }
 
 /**
- * @brief Delete the object with the given id and return success
+ * @brief Returns the first position in [first, last) of ids sorted in this store's id order,
+ *        which is not before id. Searches with exponentially growing steps from first, 
+ *        so that short distances are found quickly
  * 
- * @param id  id of the object to delete
- * @return true / false 
+ * @param ids  sorted ids
+ * @param first 
+ * @param last 
+ * @param id  id to look for
+ * @return size_t  position
  */
-template<class T>
-bool spObjectStore<T>::deleteObjById(const std::string &id)
+template <class T>
+size_t spObjectStore<T>::gallop(const std::vector<std::string> &ids, size_t first, size_t last, const std::string &id)
 {
-  if (indexOf(id, nullptr) == -1){
-    return false;
+  if ((first >= last) || (compareIds(ids[first], id) >= 0))
+  {
+    return first;
   }
-  _ids.erase(_ids.begin() + _index);
-  _objects.erase(_objects.begin() + _index);
-  return true;
+  // ids[low] is before id
+  size_t low = first;
+  size_t step = 1;
+  while ((low + step < last) && (compareIds(ids[low + step], id) < 0))
+  {
+    low += step;
+    step *= 2;
+  }
+  size_t high = std::min(low + step, last);
+  return std::partition_point(ids.begin() + low + 1, ids.begin() + high, 
+                              [this, &id](const std::string &e) { return compareIds(e, id) < 0; }) - ids.begin();
 }
 
 /**
- * @brief Delete the object with the given object arguments and return success
+ * @brief Merge the ranges [firstA, lastA) of this and [firstB, lastB) of the other store,
+ *        both sorted by ids in the same direction, and call func(posA, posB) for matching 
+ *        ids and, if allA is true, func(posA, SIZE_MAX) for ids missing in the other store.
+ *        Returns false if func returned false
  * 
- * @param args arguments used when object was constructed 
+ * @param other  the other store
+ * @param firstA 
+ * @param lastA 
+ * @param firstB 
+ * @param lastB 
+ * @param allA  true to call func for all entries of this store
+ * @param func  function of type bool func(size_t posA, size_t posB)
  * @return true / false 
  */
-template<class T> template<class... Vs>
-bool spObjectStore<T>::deleteObjFromArgs(Vs ...args)
+template <class T> template <class U, class F>
+bool spObjectStore<T>::matchRange(spObjectStore<U> &other, size_t firstA, size_t lastA, size_t firstB, size_t lastB, bool allA, F func)
 {
-  T obj = T(args...);
-  if (indexOf("", &obj) == -1){
-    return false;
+  size_t posA = firstA;
+  size_t posB = firstB;
+  while (posA < lastA)
+  {
+    posB = gallop(other._ids, posB, lastB, _ids[posA]);
+    if ((posB < lastB) && (other._ids[posB] == _ids[posA]))
+    {
+      if (!func(posA, posB))
+      {
+        return false;
+      }
+      posA++;
+      posB++;
+    }
+    else if (allA)
+    {
+      if (!func(posA, SIZE_MAX))
+      {
+        return false;
+      }
+      posA++;
+    }
+    else
+    {
+      if (posB >= lastB)
+      {
+        break;
+      }
+      // skip entries of this store before the other store's id
+      posA = gallop(_ids, posA + 1, lastA, other._ids[posB]);
+    }
   }
-  _ids.erase(_ids.begin() + _index);
-  _objects.erase(_objects.begin() + _index);
   return true;
 }
 
 /**
- * @brief Delete all objects
+ * @brief Call func(posA, posB) for all ids existing in this and the other store and, if allA
+ *        is true, func(posA, SIZE_MAX) for ids missing in the other store, in this store's
+ *        order until func returns false
  * 
+ * @param other  the other store
+ * @param allA  true to call func for all entries of this store
+ * @param func  function of type bool func(size_t posA, size_t posB)
  */
-template <class T>
-void spObjectStore<T>::reset()
+template <class T> template <class U, class F>
+void spObjectStore<T>::matchAll(spObjectStore<U> &other, bool allA, F func)
 {
-  _ids.clear();
-  _objects.clear();
+  normalize();
+  other.normalize();
+  if (hasSameIdOrder(other))
+  {
+    matchRange(other, 0, _ids.size(), 0, other._ids.size(), allA, func);
+    return;
+  }
+  std::unordered_map<std::string, size_t> positions;
+  positions.reserve(other._ids.size());
+  for (size_t i = 0; i < other._ids.size(); i++)
+  {
+    positions[other._ids[i]] = i;
+  }
+  for (size_t posA = 0; posA < _ids.size(); posA++)
+  {
+    auto it = positions.find(_ids[posA]);
+    if ((it != positions.end()) || allA)
+    {
+      if (!func(posA, (it != positions.end()) ? it->second : SIZE_MAX))
+      {
+        return;
+      }
+    }
+  }
 }
 
 /**
- * @brief Loop through all entries and call function callback(obj)
+ * @brief Rebuild all indexes from the current entries, used after changing many entries at once
  * 
- * @param callback  function of type func(const class &obj)
  */
 template <class T>
-void spObjectStore<T>::forEach(spos_forEach_O_callback callback)
+void spObjectStore<T>::rebuildIndexes()
 {
-  size_t count = _objects.size();
-  for (size_t i = 0; i < count; i++) {
-    if (callback(_objects.at(i)) == false){
-      break;
-    }
+  for (size_t i = 0; i < _indexes.size(); i++)
+  {
+    _indexes[i]->onRebuild(_ids, _objects);
   }
 }
 
 /**
- * @brief Loop through all entries and call function callback(id, obj)
+ * @brief Count a change and report it to the change callback, if set
  * 
- * @param callback  function of type func(const std::string &id, const class &obj)
+ * @param op  type of change
+ * @param id  id of the entry changed, empty for reset and re-sort
+ * @param obj  object inserted or replaced, nullptr otherwise
  */
 template <class T>
-void spObjectStore<T>::forEach(spos_forEach_IO_callback callback)
+void spObjectStore<T>::emitChange(sposChangeOp op, const std::string &id, const T *obj)
 {
-  size_t count = _objects.size();
-  for (size_t i = 0; i < count; i++) {
-    if (callback(_ids[i] , _objects.at(i)) == false){
-      break;
-    }
+  _changeSeq++;
+  if (_versioning)
+  {
+    recordVersion(op, id);
+  }
+  if (_changeCB == nullptr)
+  {
+    return;
+  }
+  sposChange<T> change;
+  change.op = op;
+  change.id = id;
+  change.seq = _changeSeq;
+  if (obj != nullptr)
+  {
+    change.obj = shareCopy(*obj, std::is_copy_constructible<T>());
   }
+  _changeCB(change);
 }
 
 /**
- * @brief Returns the value by which the capacity is incremented when needed
+ * @brief Returns a shared copy of the object for a change, or nullptr for objects that 
+ *        cannot be copied
  * 
- * @return int32_t value of increment
+ * @param obj  the object
+ * @return std::shared_ptr<const T> 
  */
 template <class T>
-size_t spObjectStore<T>::getCapacityInc()
+std::shared_ptr<const T> spObjectStore<T>::shareCopy(const T &obj, std::true_type)
 {
-  return _capaInc;
+  return std::make_shared<const T>(obj);
+}
+template <class T>
+std::shared_ptr<const T> spObjectStore<T>::shareCopy(const T & /* obj */, std::false_type)
+{
+  return nullptr;
 }
 
 /**
- * @brief Set the value used to increment the capacity when needed
+ * @brief Returns whether an object with this id is stored once the batch is committed
  * 
- * @param newInc value of new increment
+ * @param id  id of the object
+ * @return true / false
  */
 template <class T>
-void spObjectStore<T>::setCapacityInc(size_t newInc)
+bool spObjectStore<T>::isStaged(const std::string &id)
 {
-  if (newInc > 1){
-    _capaInc = newInc;
+  auto it = _batchIds.find(id);
+  if (it != _batchIds.end())
+  {
+    return it->second;
+  }
+  if (_batchReset)
+  {
+    return false;
+  }
+  // entries sorted by a compare callback cannot be found by their ids with indexOf()
+  if ((_compareCB != nullptr) && isSorted())
+  {
+    return std::find(_ids.begin(), _ids.end(), id) != _ids.end();
   }
+  return indexOf(id, nullptr) > -1;
 }
 
 /**
- * @brief Returns the number of objects in the store
+ * @brief Stage adding or replacing the object with this id for the batch
  * 
- * @return size_t number
+ * @param id  id of the object
+ * @param obj  the staged object
+ * @return T* pointer to the staged object, which may still be changed until commit()
  */
 template <class T>
-size_t spObjectStore<T>::getSize()
+T* spObjectStore<T>::stageObj(const std::string &id, std::shared_ptr<T> obj)
 {
-  return _ids.size();
+  setAdded(!isStaged(id));
+  sposChange<T> change;
+  change.op = _added ? ChangeInsert : ChangeReplace;
+  change.id = id;
+  change.obj = obj;
+  change.seq = 0;
+  _batch.push_back(change);
+  _batchIds[id] = true;
+  return obj.get();
 }
 
 /**
- * @brief Returns the status of last call to addObjWithId(), addObjFromArgs() and 
- *        setObjWithId() with regard to a new entry having been added 
+ * @brief Stage deleting the object with this id for the batch
  * 
- * @return true / false 
+ * @param id  id of the object
  */
 template <class T>
-bool spObjectStore<T>::isAdded()
+void spObjectStore<T>::stageErase(const std::string &id)
 {
-  return _added;
+  sposChange<T> change;
+  change.op = ChangeErase;
+  change.id = id;
+  change.seq = 0;
+  _batch.push_back(change);
+  _batchIds[id] = false;
 }
 
 /**
- * @brief Returns whether or not the store is sorted 
+ * @brief Apply the given changes, at most one per id, in one pass over the entries and 
+ *        rebuild the indexes once. Stores sorted by ids merge the changes sorted by ids, 
+ *        others replace and erase in place, append new entries and re-sort once if sorted
  * 
- * @return true / false 
+ * @param changes  changes to apply
+ * @param order  positions in changes to apply
+ * @param moveObjs  true to move the objects of the changes
  */
 template <class T>
-bool spObjectStore<T>::isSorted()
+void spObjectStore<T>::mergeChanges(const std::vector<sposChange<T>> &changes, std::vector<size_t> &order, bool moveObjs)
 {
-  return ((_compareCB != nullptr) || (_sorting != None));
+  normalize();
+  if (!isSortedById())
+  {
+    std::unordered_map<std::string, size_t> positions;
+    positions.reserve(_ids.size());
+    for (size_t i = 0; i < _ids.size(); i++)
+    {
+      positions[_ids[i]] = i;
+    }
+    std::vector<uint8_t> keep(_ids.size(), 1);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      const sposChange<T> &change = changes[order[i]];
+      auto it = positions.find(change.id);
+      if (change.op == ChangeErase)
+      {
+        if (it != positions.end())
+        {
+          keep[it->second] = 0;
+          emitChange(ChangeErase, change.id, nullptr);
+        }
+      }
+      else if (change.obj != nullptr)
+      {
+        if (it != positions.end())
+        {
+          _objects[it->second] = takeObj(*change.obj, moveObjs);
+          emitChange(ChangeReplace, change.id, &_objects[it->second]);
+        }
+        else
+        {
+          _ids.push_back(change.id);
+          _objects.push_back(takeObj(*change.obj, moveObjs));
+          keep.push_back(1);
+          emitChange(ChangeInsert, _ids.back(), &_objects.back());
+        }
+      }
+    }
+    compactEntries(keep);
+    if (isSorted())
+    {
+      sortEntries();
+    }
+    rebuildIndexes();
+    return;
+  }
+
+  std::sort(order.begin(), order.end(), 
+            [this, &changes](size_t a, size_t b) { return compareIds(changes[a].id, changes[b].id) < 0; });
+  std::vector<std::string> ids;
+  std::vector<T> objects;
+  ids.reserve(_ids.size() + order.size() + _capaInc);
+  objects.reserve(_ids.size() + order.size() + _capaInc);
+  size_t pos = 0;
+  size_t count = _ids.size();
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    const sposChange<T> &change = changes[order[i]];
+    while ((pos < count) && (compareIds(_ids[pos], change.id) < 0))
+    {
+      ids.push_back(std::move(_ids[pos]));
+      objects.push_back(std::move(_objects[pos]));
+      pos++;
+    }
+    bool existing = (pos < count) && (_ids[pos] == change.id);
+    if (change.op == ChangeErase)
+    {
+      if (existing)
+      {
+        emitChange(ChangeErase, change.id, nullptr);
+      }
+    }
+    else if (change.obj != nullptr)
+    {
+      ids.push_back(change.id);
+      objects.push_back(takeObj(*change.obj, moveObjs));
+      emitChange(existing ? ChangeReplace : ChangeInsert, ids.back(), &objects.back());
+    }
+    else if (existing)
+    {
+      ids.push_back(std::move(_ids[pos]));
+      objects.push_back(std::move(_objects[pos]));
+    }
+    if (existing)
+    {
+      pos++;
+    }
+  }
+  for (; pos < count; pos++)
+  {
+    ids.push_back(std::move(_ids[pos]));
+    objects.push_back(std::move(_objects[pos]));
+  }
+  _ids.swap(ids);
+  _objects.swap(objects);
+  rebuildIndexes();
 }
 
 /**
- * @brief Returns the current sorting method
+ * @brief Returns a copy of the object or the object moved out, e.g. of another store or of 
+ *        a change staged in a batch. Objects that cannot be copied are always moved
  * 
- * @tparam T 
- * @return sposSort 
+ * @param obj  the object
+ * @param moveObj  true to move the object
+ * @return T  the object
  */
 template <class T>
-sposSort spObjectStore<T>::getSorting()
+T spObjectStore<T>::takeObj(const T &obj, bool moveObj)
 {
-  return _sorting;
+  return takeObj(obj, moveObj, std::is_copy_constructible<T>());
+}
+template <class T>
+T spObjectStore<T>::takeObj(const T &obj, bool moveObj, std::true_type)
+{
+  if (!moveObj)
+  {
+    return T(obj);
+  }
+  return takeObj(obj, moveObj, std::false_type());
+}
+template <class T>
+T spObjectStore<T>::takeObj(const T &obj, bool /* moveObj */, std::false_type)
+{
+  // only objects which are not const are moved, e.g. staged ones created by the store
+  return std::move(const_cast<T&>(obj));
 }
 
 /**
- * @brief Set the sorting
+ * @brief Set the version of the changed entry to the current sequence number, or of all 
+ *        entries with a reset, and append it to the version log. The log is compacted 
+ *        once it holds more outdated than current versions
  * 
- * @param sorting  either None, ASC or DESC
+ * @param op  type of change
+ * @param id  id of the entry changed
  */
 template <class T>
-void spObjectStore<T>::setSorting(sposSort sorting)
+void spObjectStore<T>::recordVersion(sposChangeOp op, const std::string &id)
 {
-  if (sorting == _sorting)
+  if (op == ChangeResort)
   {
     return;
   }
-  _sorting = sorting;
+  if (op == ChangeReset)
+  {
+    for (auto it = _versions.begin(); it != _versions.end(); ++it)
+    {
+      if (!it->second.second)
+      {
+        it->second = std::make_pair(_changeSeq, true);
+        _versionLog.emplace_back(_changeSeq, it->first);
+      }
+    }
+  }
+  else
+  {
+    _versions[id] = std::make_pair(_changeSeq, op == ChangeErase);
+    _versionLog.emplace_back(_changeSeq, id);
+  }
 
-  if (sorting != None)
+  if (_versionLog.size() > 2 * _versions.size() + 64)
   {
-    // recreate with preserved ids
-    recreate(true);
+    size_t kept = 0;
+    for (size_t i = 0; i < _versionLog.size(); i++)
+    {
+      auto state = _versions.find(_versionLog[i].second);
+      if ((state != _versions.end()) && (state->second.first == _versionLog[i].first))
+      {
+        if (kept != i)
+        {
+          _versionLog[kept] = std::move(_versionLog[i]);
+        }
+        kept++;
+      }
+    }
+    _versionLog.resize(kept);
   }
 }
 
 /**
- * @brief Returns the string used as separator when creating ids from arguments. 
- *        The default is '#/#', which is producing ids of key1#/#key2.. pattern
+ * @brief Sort all entries in one pass by the compare callback and ids or by ids only, 
+ *        i.e. in the order indexOf() expects, without updating indexes
  * 
- * @return std::string  the separator
  */
 template <class T>
-std::string spObjectStore<T>::getIdSeparator()
+void spObjectStore<T>::sortEntries()
 {
-  return _idSep;
+  size_t count = _ids.size();
+  std::vector<size_t> order(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    int32_t cmpRes = (_compareCB == nullptr) ? 0 : _compareCB(_objects[a], _objects[b]);
+    if (cmpRes == 0)
+    {
+      cmpRes = compareIds(_ids[a], _ids[b]);
+    }
+    return cmpRes < 0;
+  });
+  std::vector<std::string> ids;
+  std::vector<T> objects;
+  ids.reserve(_ids.capacity());
+  objects.reserve(_objects.capacity());
+  for (size_t i = 0; i < count; i++)
+  {
+    ids.push_back(std::move(_ids[order[i]]));
+    objects.push_back(std::move(_objects[order[i]]));
+  }
+  _ids.swap(ids);
+  _objects.swap(objects);
+  _tailIds.clear();
 }
 
 /**
- * @brief Set the string to be used as separator when creating ids from arguments. 
- *        The default is '#/#', which is producing ids of key1#/#key2.. pattern
+ * @brief Remove all entries not flagged in keep in one pass, preserving the order of the 
+ *        others, without updating indexes
  * 
- * @param separator 
+ * @param keep  flag per position, 0 to remove the entry
  */
 template <class T>
-void spObjectStore<T>::setIdSeparator(std::string separator)
+void spObjectStore<T>::compactEntries(const std::vector<uint8_t> &keep)
 {
-  if (separator.length() > 0)
+  size_t count = _ids.size();
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++)
   {
-    _idSep = separator;
+    if (keep[i])
+    {
+      if (kept != i)
+      {
+        _ids[kept] = std::move(_ids[i]);
+        _objects[kept] = std::move(_objects[i]);
+      }
+      kept++;
+    }
   }
+  _ids.erase(_ids.begin() + kept, _ids.end());
+  _objects.erase(_objects.begin() + kept, _objects.end());
 }
 
 /**
- * @brief Returns the number of decimals used to format an id from a floating point value.
- *        
- * @return uint8_t  the length of string for decimals portion of value
+ * @brief Returns true if new entries go to the write buffer
+ * 
+ * @return true / false 
  */
 template <class T>
-uint8_t spObjectStore<T>::getIdNumDecimals()
+bool spObjectStore<T>::isBuffering()
 {
-  return _idNumDecimals;
+  return ((_writeBuffer > 0) || _lazySorting) && isSortedById();
 }
 
 /**
- * @brief Set the number of decimals used to format an id from a floating point value.
+ * @brief Returns the positions of the entries in the write buffer, sorted by their ids
  * 
- * @param digits  the length of the string for the decimals portion of a value
+ * @return std::vector<size_t> 
  */
 template <class T>
-void spObjectStore<T>::setIdNumDecimals(uint8_t decimals)
+std::vector<size_t> spObjectStore<T>::tailOrder()
 {
-  if (decimals > 0)
+  std::vector<size_t> tail;
+  tail.reserve(_tailIds.size());
+  for (size_t i = _tailStart; i < _ids.size(); i++)
   {
-    _idNumDecimals = decimals;
+    tail.push_back(i);
   }
+  std::sort(tail.begin(), tail.end(), [this](size_t a, size_t b) { return compareIds(_ids[a], _ids[b]) < 0; });
+  return tail;
 }
 
 /**
- * @brief Returns the number of digits used to format an id from a numeric value.
- *        
- * @return uint8_t  the length of the string (integer portion for floating point value)
- */
-template <class T>
-uint8_t spObjectStore<T>::getIdNumDigits()
-{
-  return _idNumDigits;
-}
-
-/**
- * @brief Set the number of digits used to format an id from a numeric value.
+ * @brief Add the other store's entries with ids not existing in this store, either copied 
+ *        or moved. Stores sorted by ids in the same direction are merged in one pass
  * 
- * @param digits  the length of the string (integer portion for floating point value)
+ * @param other  the store to unite with
+ * @param moveObjs  true to move objects out of the other store
  */
 template <class T>
-void spObjectStore<T>::setIdNumDigits(uint8_t digits)
+void spObjectStore<T>::unionFrom(spObjectStore<T> &other, bool moveObjs)
 {
-  if (digits > 0)
+  if (this == &other)
   {
-    _idNumDigits = digits;
+    return;
   }
-}
+  normalize();
+  other.normalize();
+  size_t countA = _ids.size();
+  size_t countB = other._ids.size();
 
-/**
- * @brief Returns an id created from arguments. In case no argument is given,
- *        an auto generated one will be returned
- * 
- * @param args  any arguments privide will be concatenated into an id
- * @return std::string  the id created
- */
-template <class T> template <class... Vs>
-std::string spObjectStore<T>::makeIdFromArgs(Vs... args)
-{
-  int8_t numArgs = sizeof...(args);
-  if (numArgs > 0)
+  if (hasSameIdOrder(other))
   {
-    return makeIdFrom(args...);
+    std::vector<std::string> ids;
+    std::vector<T> objects;
+    ids.reserve(countA + countB + _capaInc);
+    objects.reserve(countA + countB + _capaInc);
+    size_t posA = 0;
+    size_t posB = 0;
+    while ((posA < countA) || (posB < countB))
+    {
+      if ((posB >= countB) || ((posA < countA) && (compareIds(_ids[posA], other._ids[posB]) <= 0)))
+      {
+        if ((posB < countB) && (_ids[posA] == other._ids[posB]))
+        {
+          posB++;
+        }
+        ids.push_back(std::move(_ids[posA]));
+        objects.push_back(std::move(_objects[posA]));
+        posA++;
+      }
+      else
+      {
+        ids.push_back(other._ids[posB]);
+        objects.push_back(takeObj(other._objects[posB], moveObjs));
+        emitChange(ChangeInsert, ids.back(), &objects.back());
+        posB++;
+      }
+    }
+    _ids.swap(ids);
+    _objects.swap(objects);
+    rebuildIndexes();
+    return;
   }
-  else
+
+  // hash probing for the missing ones
+  std::unordered_set<std::string> existing(_ids.begin(), _ids.end());
+  if (isSorted() && !isSortedById())
   {
-    return makeIdFrom(_autoId++);
+    // sorted by compare callback, insert one by one
+    for (size_t posB = 0; posB < countB; posB++)
+    {
+      if ((existing.count(other._ids[posB]) == 0) && (indexOf(other._ids[posB], &other._objects[posB]) == -1))
+      {
+        setAdded(true);
+        insertAt(_index, other._ids[posB], takeObj(other._objects[posB], moveObjs));
+      }
+    }
+    return;
   }
+  setCapacity(countA + countB + _capaInc);
+  for (size_t posB = 0; posB < countB; posB++)
+  {
+    if (existing.count(other._ids[posB]) == 0)
+    {
+      _ids.push_back(other._ids[posB]);
+      _objects.push_back(takeObj(other._objects[posB], moveObjs));
+      emitChange(ChangeInsert, _ids.back(), &_objects.back());
+    }
+  }
+  if (isSortedById())
+  {
+    sortEntries();
+  }
+  rebuildIndexes();
 }
 
 /**
- * @brief Set the callback to be invoked for creating ids and then rebuild 
- *        all stored ids. If needed, sort all existing entries
+ * @brief Move the given entries into this store, replacing entries with the same ids, and
+ *        rebuild the indexes once. Entries in this store's id order (inOrder = true) are 
+ *        appended as one chunk if they all come after the stored ones or merged in one 
+ *        pass, moving the stored entries between them in chunks. Others replace in place 
+ *        and are appended, re-sorting once if sorted
  * 
- * @param callback  function of type func(const class &obj)
+ * @param ids  ids of the entries, which are moved
+ * @param objects  objects of the entries, which are moved
+ * @param inOrder  true if the ids are sorted in this store's id order
  */
 template <class T>
-void spObjectStore<T>::setCreateIdCallback(spos_create_id_callback callback)
+void spObjectStore<T>::mergeEntries(std::vector<std::string> &ids, std::vector<T> &objects, bool inOrder)
 {
-  if (&_createIdCB == &callback)
+  if (ids.empty())
   {
     return;
   }
-  _createIdCB = callback;
-
-  // recreate with new ids
-  recreate(false);
+  if (_batching)
+  {
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      sposNode<T> node;
+      node.id = std::move(ids[i]);
+      node.obj.emplace(std::move(objects[i]));
+      insert(std::move(node));
+    }
+    return;
+  }
+  normalize();
+  size_t count = _ids.size();
+  inOrder = inOrder && isSortedById();
+  if (inOrder && ((count == 0) || (compareIds(_ids.back(), ids.front()) < 0)))
+  {
+    // one chunk after the stored entries
+    if (count == 0)
+    {
+      _ids.swap(ids);
+      _objects.swap(objects);
+    }
+    else
+    {
+      _ids.insert(_ids.end(), std::make_move_iterator(ids.begin()), std::make_move_iterator(ids.end()));
+      _objects.insert(_objects.end(), std::make_move_iterator(objects.begin()), std::make_move_iterator(objects.end()));
+    }
+    for (size_t i = count; i < _ids.size(); i++)
+    {
+      emitChange(ChangeInsert, _ids[i], &_objects[i]);
+    }
+  }
+  else if (inOrder)
+  {
+    std::vector<std::string> mergedIds;
+    std::vector<T> mergedObjects;
+    mergedIds.reserve(count + ids.size() + _capaInc);
+    mergedObjects.reserve(count + ids.size() + _capaInc);
+    size_t pos = 0;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      // stored entries before the id as one chunk
+      size_t next = gallop(_ids, pos, count, ids[i]);
+      mergedIds.insert(mergedIds.end(), std::make_move_iterator(_ids.begin() + pos), std::make_move_iterator(_ids.begin() + next));
+      mergedObjects.insert(mergedObjects.end(), std::make_move_iterator(_objects.begin() + pos), std::make_move_iterator(_objects.begin() + next));
+      pos = next;
+      bool existing = (pos < count) && (_ids[pos] == ids[i]);
+      mergedIds.push_back(std::move(ids[i]));
+      mergedObjects.push_back(std::move(objects[i]));
+      emitChange(existing ? ChangeReplace : ChangeInsert, mergedIds.back(), &mergedObjects.back());
+      if (existing)
+      {
+        pos++;
+      }
+    }
+    mergedIds.insert(mergedIds.end(), std::make_move_iterator(_ids.begin() + pos), std::make_move_iterator(_ids.end()));
+    mergedObjects.insert(mergedObjects.end(), std::make_move_iterator(_objects.begin() + pos), std::make_move_iterator(_objects.end()));
+    _ids.swap(mergedIds);
+    _objects.swap(mergedObjects);
+  }
+  else
+  {
+    std::unordered_map<std::string, size_t> positions;
+    positions.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      positions[_ids[i]] = i;
+    }
+    setCapacity(count + ids.size() + _capaInc);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      auto it = positions.find(ids[i]);
+      if (it != positions.end())
+      {
+        _objects[it->second] = std::move(objects[i]);
+        emitChange(ChangeReplace, ids[i], &_objects[it->second]);
+      }
+      else
+      {
+        _ids.push_back(std::move(ids[i]));
+        _objects.push_back(std::move(objects[i]));
+        emitChange(ChangeInsert, _ids.back(), &_objects.back());
+      }
+    }
+    if (isSorted())
+    {
+      sortEntries();
+    }
+  }
+  rebuildIndexes();
 }
 
 /**
- * @brief Set the callback to be invoked when sorting objects (i.e. comparing two objects)
- *        and sort all existing entries
+ * @brief Keep only the entries with ids existing (matching = true) or not existing 
+ *        (matching = false) in the other store
  * 
- * @param callback  function of type func(const class &obj1, const class &obj2)
+ * @param other  the store to compare with
+ * @param matching  true to keep entries with ids in the other store
  */
-template <class T>
-void spObjectStore<T>::setCompareCallback(spos_compare_callback callback)
+template <class T> template <class U>
+void spObjectStore<T>::retainFrom(spObjectStore<U> &other, bool matching)
 {
-  if (&_compareCB == &callback)
+  normalize();
+  std::vector<uint8_t> keep(_ids.size(), 0);
+  matchAll(other, true, [&keep, matching](size_t posA, size_t posB) {
+    keep[posA] = ((posB != SIZE_MAX) == matching) ? 1 : 0;
+    return true;
+  });
+  for (size_t i = 0; i < keep.size(); i++)
   {
-    return;
+    if (!keep[i])
+    {
+      emitChange(ChangeErase, _ids[i], nullptr);
+    }
   }
-  _compareCB = callback;
-
-  // recreate with preserved ids
-  recreate(true);
+  compactEntries(keep);
+  rebuildIndexes();
 }
 
 
+/*    QUERY    QUERY    QUERY    QUERY
 
-/*    PRIVATE    PRIVATE    PRIVATE    PRIVATE
-
-      xxxxxxx   xxxxxxx      xx     xx    xx     xx     xxxxxxxx  xxxxxxxx
-      xx    xx  xx    xx     xx     xx    xx    xxxx       xx     xx      
-      xx    xx  xx    xx     xx     xx    xx   xx  xx      xx     xx      
-      xxxxxxx   xxxxxxx      xx      xx  xx   xx    xx     xx     xxxxxxx    
-      xx        xx    xx     xx      xx  xx   xxxxxxxx     xx     xx    
-      xx        xx    xx     xx       xxxx    xx    xx     xx     xx      
-      xx        xx    xx     xx        xx     xx    xx     xx     xxxxxxxx
-     
-
-      PRIVATE    PRIVATE    PRIVATE    PRIVATE    */
+      spObjectQuery<T> member functions
 
+      QUERY    QUERY    QUERY    QUERY    */
 
 
 /**
- * @brief Return the result of comparing of two ids in dependence of None, ASC or DESC 
- * 
- * @param id1 
- * @param id2 
- * @return int32_t 
+ * constructor - a query on the given store, which must outlive the query
  */
 template <class T>
-int32_t spObjectStore<T>::compareIds(const std::string &id1, const std::string &id2)
+spObjectQuery<T>::spObjectQuery(spObjectStore<T> *store)
 {
-  int32_t cmpRes = strcmp(id1.c_str(), id2.c_str());
-  if (_sorting == DESC)
-  {
-    cmpRes *= -1;
-  }
-  return cmpRes;
+  _store = store;
 }
 
 /**
- * @brief Get the index (=_index) for an object's id and/or object.
- *        Returns -1 if it does not exist (_index is then the position to insert new entry)
+ * @brief Add a predicate comparing a member of the objects with a value. If the store
+ *        has an index on this member, it may be used to find the matching entries
  * 
- * @param id 
- * @return int32_t index 
+ * @param member  pointer to the member, e.g. &myObject::_number
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @return spObjectQuery<T>&  this query for chaining
  */
-template <class T>
-int32_t spObjectStore<T>::indexOf(const std::string &id, T *obj)
+template <class T> template <class M, class V>
+typename std::enable_if<std::is_member_object_pointer<M>::value, spObjectQuery<T>&>::type spObjectQuery<T>::andWhere(M member, sposOp op, const V &value)
 {
-  size_t count = _ids.size();
-  // we already worked on it?
-  if ((_index > -1) && (_index < count) && (_ids[_index] == id)){
-    return _index;
+  typedef typename spos_member_traits<M>::value_type U;
+  U v = value;
+  spObjectStore<T> *store = _store;
+  spos_predicate predicate;
+
+  // name the field after its index, if there is one
+  std::string field = "field";
+  for (size_t i = 0; i < store->_indexes.size(); i++)
+  {
+    spos_index<T> *index = store->_indexes[i].get();
+    if (((index->_typeTag == spos_type_tag<spos_sorted_index<T, U>>()) &&
+         (static_cast<spos_sorted_index<T, U>*>(index)->_member == member)) ||
+        (isProjectionOf(index, member)))
+    {
+      field = index->_name;
+      break;
+    }
   }
-  if (isSorted()){
-    // let's find it with lower bound implementation
-    uint32_t step;
-    uint32_t first = 0;
-    uint32_t sIdx;
-    int32_t cmpRes;
-    
-    while (count > 0){
-      sIdx = first;
-      step = count / 2;
-      sIdx += step;
-      //cmpRes of <0 = A has lower value, 0 = same, >0 = A has higher value
-      if ((_compareCB == nullptr) || (obj == nullptr)){
-        cmpRes = compareIds(_ids[sIdx].c_str(), id.c_str());
-      } else {
-        cmpRes = _compareCB(_objects[sIdx], *obj);
-        // when looking at same obj values, i.e. xmpRes = 0, we need to check ids, except id == ""
-        if ((cmpRes == 0) && (id.length() > 0))
-        {
-          cmpRes = compareIds(_ids[sIdx].c_str(), id.c_str());
-        }
-      }
-      
-      if (cmpRes < 0){
-          first = ++sIdx;
-          count -= step + 1;
-      } else if(cmpRes == 0) {
-        _index = sIdx;
-        return _index;
-      } else {
-        count = step;
-      }
+  predicate.text = field + " " + opText(op) + " " + valueText(v);
+
+  predicate.filter = [member, op, v](const std::string & /* id */, const T &obj) {
+    const U &objValue = obj.*member;
+    switch (op)
+    {
+      case Equal:         return !(objValue < v) && !(v < objValue);
+      case NotEqual:      return (objValue < v) || (v < objValue);
+      case Less:          return objValue < v;
+      case LessEqual:     return !(v < objValue);
+      case Greater:       return v < objValue;
+      case GreaterEqual:  return !(objValue < v);
     }
-    _index = first;
-    return -1;
+    return false;
+  };
 
-  } else {
-    // not sorted, let's find it by looping from 0 to n
-    for (_index = 0; _index < count; _index++) {
-      if (_ids[_index] == id) {
-        return _index;
+  predicate.lookup = [store, member, op, v](bool collect, std::vector<size_t> &positions, size_t &count, std::string &name) {
+    for (size_t i = 0; i < store->_indexes.size(); i++)
+    {
+      spos_index<T> *index = store->_indexes[i].get();
+      if (scanProjection(index, member, op, v, collect, positions, count, name))
+      {
+        return true;
+      }
+      if (index->_typeTag != spos_type_tag<spos_sorted_index<T, U>>())
+      {
+        continue;
+      }
+      spos_sorted_index<T, U> *sortedIndex = static_cast<spos_sorted_index<T, U>*>(index);
+      size_t first;
+      size_t last;
+      if ((sortedIndex->_member != member) || !sortedIndex->range(op, v, first, last))
+      {
+        continue;
+      }
+      count = last - first;
+      name = "index scan on '" + sortedIndex->_name + "'";
+      if (collect)
+      {
+        positions.reserve(count);
+        for (size_t j = first; j < last; j++)
+        {
+          positions.push_back(sortedIndex->_entries[j].second);
+        }
+        // keep the store's order
+        std::sort(positions.begin(), positions.end());
       }
+      return true;
     }
-  }
-  return -1;
+    return false;
+  };
+
+  _predicates.push_back(predicate);
+  return *this;
 }
 
 /**
- * @brief Set capacity to new increased value
+ * @brief Add a predicate comparing the ids with a value. If the store is sorted by ids
+ *        (ASC or DESC), the matching range is found by binary search
  * 
- * @param capacity  new size
+ * @param op  comparison operator
+ * @param id  value to compare with
+ * @return spObjectQuery<T>&  this query for chaining
  */
 template <class T>
-void spObjectStore<T>::setCapacity(size_t capacity)
+spObjectQuery<T>& spObjectQuery<T>::andWhereId(sposOp op, const std::string &id)
 {
-  if (capacity > _ids.capacity())
-  {
-    _ids.reserve(capacity);
-    _objects.reserve(capacity);
-  }  
-}
+  spObjectStore<T> *store = _store;
+  spos_predicate predicate;
+  predicate.text = "id " + opText(op) + " " + valueText(id);
+
+  predicate.filter = [op, id](const std::string &entryId, const T & /* obj */) {
+    int cmpRes = strcmp(entryId.c_str(), id.c_str());
+    switch (op)
+    {
+      case Equal:         return cmpRes == 0;
+      case NotEqual:      return cmpRes != 0;
+      case Less:          return cmpRes < 0;
+      case LessEqual:     return cmpRes <= 0;
+      case Greater:       return cmpRes > 0;
+      case GreaterEqual:  return cmpRes >= 0;
+    }
+    return false;
+  };
 
+  predicate.lookup = [store, op, id](bool collect, std::vector<size_t> &positions, size_t &count, std::string &name) {
+    if (!store->isSortedById() || (op == NotEqual))
+    {
+      return false;
+    }
+    size_t first;
+    size_t last;
+    store->idRange(op, id, first, last);
+    count = last - first;
+    name = "id range scan";
+    if (collect)
+    {
+      positions.reserve(count);
+      for (size_t j = first; j < last; j++)
+      {
+        positions.push_back(j);
+      }
+    }
+    return true;
+  };
+
+  _predicates.push_back(predicate);
+  return *this;
+}
 
 /**
- * @brief Set _added status and, if needed, expand the vectors' capacity
+ * @brief Add a predicate being a filter function, which returns true for entries to keep
  * 
- * @param added 
+ * @param filter  function of type func(const std::string &id, const class &obj)
+ * @return spObjectQuery<T>&  this query for chaining
  */
 template <class T>
-void spObjectStore<T>::setAdded(bool added)
+spObjectQuery<T>& spObjectQuery<T>::andWhere(spos_filter_callback filter)
 {
-  // if already false, return
-  if (!added && !_added){
-    return;
-  }
-  // otherwise set and check capa
-  _added = added;
-  size_t count = _ids.size();
-  if (added && (count + 2  > _ids.capacity())){
-    setCapacity(count + _capaInc);
-  }
+  spos_predicate predicate;
+  predicate.text = "filter function";
+  predicate.filter = filter;
+  _predicates.push_back(predicate);
+  return *this;
 }
 
 /**
- * @brief Returns the formatted string representation of value.
- *        Overloaded function for all types and formatted with default sizes
+ * @brief Loop through all matching entries in store order and call function callback(obj)
  * 
- * @param value 
- * @return std::string 
+ * @param callback  function of type func(const class &obj)
  */
 template <class T>
-std::string spObjectStore<T>::stringify(const uint64_t &value)
+void spObjectQuery<T>::forEach(std::function<bool(const T&)> callback)
 {
-  char buf[100];
-  snprintf(buf, 100, "%0*llu", 8, value);
-  return std::string(buf);
+  run([&callback](const std::string & /* id */, const T &obj) { return callback(obj); });
 }
+
+/**
+ * @brief Loop through all matching entries in store order and call function callback(id, obj)
+ * 
+ * @param callback  function of type func(const std::string &id, const class &obj)
+ */
 template <class T>
-std::string spObjectStore<T>::stringify(const uint32_t &value)
+void spObjectQuery<T>::forEach(std::function<bool(const std::string&, const T&)> callback)
 {
-  return stringify(static_cast<uint64_t>(value));
+  run(callback);
 }
+
+/**
+ * @brief Returns the number of matching entries
+ * 
+ * @return size_t number
+ */
 template <class T>
-std::string spObjectStore<T>::stringify(const uint16_t &value)
+size_t spObjectQuery<T>::count()
 {
-  return stringify(static_cast<uint64_t>(value));
+  size_t matches = 0;
+  run([&matches](const std::string & /* id */, const T & /* obj */) { matches++; return true; });
+  return matches;
 }
+
+/**
+ * @brief Returns a description of how the query would be executed, i.e. which index 
+ *        (if any) is used and which predicates are checked on the entries found
+ * 
+ * @return std::string  the description
+ */
 template <class T>
-std::string spObjectStore<T>::stringify(const uint8_t &value)
+std::string spObjectQuery<T>::explain()
 {
-  return stringify(static_cast<uint64_t>(value));
+  std::vector<size_t> positions;
+  size_t count = 0;
+  std::string name;
+  int32_t chosen = plan(positions, false, count, name);
+  size_t total = _store->_ids.size();
+
+  std::string res;
+  if (chosen < 0)
+  {
+    res = "full scan (" + std::to_string(total) + " entries)\n";
+  }
+  else
+  {
+    res = name + " (" + std::to_string(count) + " of " + std::to_string(total) + " entries)\n";
+  }
+  for (size_t i = 0; i < _predicates.size(); i++)
+  {
+    res.append((int32_t(i) == chosen) ? "  index:  " : "  filter: ");
+    res.append(_predicates[i].text);
+    res.append("\n");
+  }
+  return res;
 }
+
+
+/**
+ * @brief Returns the text for an operator as used in explain()
+ * 
+ * @param op 
+ * @return std::string 
+ */
 template <class T>
-std::string spObjectStore<T>::stringify(const int64_t &value)
+std::string spObjectQuery<T>::opText(sposOp op)
 {
-  char buf[100];
-  snprintf(buf, 100, "%0*lld", _idNumDigits, value);
-  return std::string(buf);
+  switch (op)
+  {
+    case Equal:         return "==";
+    case NotEqual:      return "!=";
+    case Less:          return "<";
+    case LessEqual:     return "<=";
+    case Greater:       return ">";
+    case GreaterEqual:  return ">=";
+  }
+  return "?";
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const int32_t &value)
+
+/**
+ * @brief Returns whether index is a projection of the given member
+ * 
+ * @param index 
+ * @param member 
+ * @return true / false 
+ */
+template <class T> template <class M>
+typename std::enable_if<std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type spObjectQuery<T>::isProjectionOf(spos_index<T> *index, M member)
 {
-  return stringify(static_cast<int64_t>(value));
+  typedef typename spos_member_traits<M>::value_type U;
+  return (index->_typeTag == spos_type_tag<spos_projection<T, U>>()) &&
+         (static_cast<spos_projection<T, U>*>(index)->_member == member);
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const int16_t &value)
+template <class T> template <class M>
+typename std::enable_if<!std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type spObjectQuery<T>::isProjectionOf(spos_index<T> * /* index */, M /* member */)
 {
-  return stringify(static_cast<int64_t>(value));
+  // only arithmetic members have projections
+  return false;
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const int8_t &value)
+
+/**
+ * @brief If index is a projection of the given member, scan its column for the values 
+ *        matching op and value, i.e. count them or collect their positions, and return 
+ *        true, otherwise return false
+ * 
+ * @param index 
+ * @param member 
+ * @param op  comparison operator
+ * @param value  value to compare with
+ * @param collect  true to fill positions
+ * @param positions  receives the positions found
+ * @param count  receives the number of entries found
+ * @param name  receives the name of the lookup
+ * @return true / false 
+ */
+template <class T> template <class M>
+typename std::enable_if<std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type spObjectQuery<T>::scanProjection(spos_index<T> *index, M member, sposOp op, const typename spos_member_traits<M>::value_type &value, bool collect, std::vector<size_t> &positions, size_t &count, std::string &name)
 {
-  return stringify(static_cast<int64_t>(value));
+  typedef typename spos_member_traits<M>::value_type U;
+  if (!isProjectionOf(index, member))
+  {
+    return false;
+  }
+  // columnar scan, exact count without touching the objects
+  spos_projection<T, U> *projection = static_cast<spos_projection<T, U>*>(index);
+  name = "projection scan on '" + projection->_name + "'";
+  if (collect)
+  {
+    projection->filter(op, value, positions);
+    count = positions.size();
+  }
+  else
+  {
+    count = projection->count(op, value);
+  }
+  return true;
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const long double &value)
+template <class T> template <class M>
+typename std::enable_if<!std::is_arithmetic<typename spos_member_traits<M>::value_type>::value, bool>::type spObjectQuery<T>::scanProjection(spos_index<T> * /* index */, M /* member */, sposOp /* op */, const typename spos_member_traits<M>::value_type & /* value */, bool /* collect */, std::vector<size_t> & /* positions */, size_t & /* count */, std::string & /* name */)
 {
-  char buf[100];
-  snprintf(buf, 100, "%+0*.*LF", _idNumSize, _idNumDecimals, value);
-  return std::string(buf);
+  return false;
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const double &value)
+
+/**
+ * @brief Returns the text for a value as used in explain()
+ * 
+ * @param value 
+ * @return std::string 
+ */
+template <class T> template <class U>
+typename std::enable_if<std::is_arithmetic<U>::value, std::string>::type spObjectQuery<T>::valueText(const U &value)
 {
-  return stringify(static_cast<long double>(value));
+  return std::to_string(value);
 }
-template <class T>
-std::string spObjectStore<T>::stringify(const float &value)
+template <class T> template <class U>
+typename std::enable_if<!std::is_arithmetic<U>::value, std::string>::type spObjectQuery<T>::valueText(const U & /* value */)
 {
-  return stringify(static_cast<long double>(value));
+  return "(value)";
 }
 template <class T>
-std::string spObjectStore<T>::stringify(const std::string &value)
+std::string spObjectQuery<T>::valueText(const std::string &value)
 {
-  return std::string(value);
+  return "\"" + value + "\"";
 }
+
+/**
+ * @brief Choose the predicate with the index lookup returning the fewest entries and 
+ *        return its number or -1 for a full scan. If collect is true, positions will 
+ *        be filled with the entries' positions in store order
+ * 
+ * @param positions  receives the positions found by the index
+ * @param collect  true to fill positions
+ * @param count  receives the number of entries found by the index
+ * @param name  receives the name of the index lookup
+ * @return int32_t 
+ */
 template <class T>
-std::string spObjectStore<T>::stringify(const char &value)
+int32_t spObjectQuery<T>::plan(std::vector<size_t> &positions, bool collect, size_t &count, std::string &name)
 {
-  return std::string(1, value);
+  _store->normalize();
+  int32_t chosen = -1;
+  for (size_t i = 0; i < _predicates.size(); i++)
+  {
+    size_t lookupCount;
+    std::string lookupName;
+    if ((_predicates[i].lookup != nullptr) && _predicates[i].lookup(false, positions, lookupCount, lookupName))
+    {
+      if ((chosen < 0) || (lookupCount < count))
+      {
+        chosen = i;
+        count = lookupCount;
+        name = lookupName;
+      }
+    }
+  }
+  if (collect && (chosen >= 0))
+  {
+    _predicates[chosen].lookup(true, positions, count, name);
+  }
+  return chosen;
 }
 
 /**
- * @brief Make an id from variadic arguments, joined together with separator.
- *        Overloaded function for no, one and many arguments
+ * @brief Execute the query and call function callback(id, obj) for matching entries
  * 
- * @return std::string 
+ * @param callback  function of type func(const std::string &id, const class &obj)
  */
-// do nothing func
 template <class T>
-std::string spObjectStore<T>::makeIdFrom()
-{
-  return "";
-}
-// one arg
-template <class T> template<class U>
-std::string spObjectStore<T>::makeIdFrom(U arg)
+void spObjectQuery<T>::run(spos_filter_callback callback)
 {
-  //return spos_stringify(arg);
-  return stringify(arg);
+  std::vector<size_t> positions;
+  size_t count = _store->_ids.size();
+  std::string name;
+  int32_t chosen = plan(positions, true, count, name);
+  bool useIndex = (chosen >= 0);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    size_t pos = useIndex ? positions[i] : i;
+    const std::string &id = _store->_ids[pos];
+    const T &obj = _store->_objects[pos];
+    bool matching = true;
+    for (size_t j = 0; j < _predicates.size(); j++)
+    {
+      if ((int32_t(j) != chosen) && !_predicates[j].filter(id, obj))
+      {
+        matching = false;
+        break;
+      }
+    }
+    if (matching && (callback(id, obj) == false))
+    {
+      break;
+    }
+  }
 }
-// many args
-template<class T> template<class U, class... Vs>
-std::string spObjectStore<T>::makeIdFrom(U arg, Vs... args)
+
+
+/*    CHANGE QUEUE    CHANGE QUEUE    CHANGE QUEUE
+
+      spObjectChangeQueue<T> member functions
+
+      CHANGE QUEUE    CHANGE QUEUE    CHANGE QUEUE    */
+
+
+/**
+ * constructor - queue holding up to capacity changes
+ */
+template <class T>
+spObjectChangeQueue<T>::spObjectChangeQueue(size_t capacity)
 {
-  //std::string res = spos_stringify(arg);
-  std::string res = stringify(arg);
-  res.append(_idSep);
-  return res.append(makeIdFrom(args...));
+  _slots.resize(capacity + 1);
 }
 
 /**
- * @brief  Returns an id created either by _createIdCB() or _autoId 
+ * @brief Add a change to the queue and return success, i.e. false if the queue is full.
+ *        Only to be called from the producer thread
  * 
- * @param obj 
- * @return std::string 
+ * @param change  the change to add
+ * @return true / false 
  */
 template <class T>
-std::string spObjectStore<T>::createId(const T &obj)
+bool spObjectChangeQueue<T>::push(const sposChange<T> &change)
 {
-  if (_createIdCB != nullptr)
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  size_t next = (tail + 1) % _slots.size();
+  if (next == _head.load(std::memory_order_acquire))
   {
-    return _createIdCB(obj);
+    return false;
   }
-  else
+  _slots[tail] = change;
+  _tail.store(next, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Take the oldest change from the queue and return success, i.e. false if the queue 
+ *        is empty. Only to be called from the consumer thread
+ * 
+ * @param change  receives the change
+ * @return true / false 
+ */
+template <class T>
+bool spObjectChangeQueue<T>::pop(sposChange<T> &change)
+{
+  size_t head = _head.load(std::memory_order_relaxed);
+  if (head == _tail.load(std::memory_order_acquire))
   {
-    return makeIdFrom(_autoId++);
+    return false;
   }
+  change = std::move(_slots[head]);
+  _slots[head].obj.reset();
+  _head.store((head + 1) % _slots.size(), std::memory_order_release);
+  return true;
 }
 
-
 /**
- * @brief Recreate the vectors (if there are entries) based on sorting choosen,
- *        either with preserved ids or newly created ones 
+ * @brief Append up to maxCount changes from the queue to changes and return their number.
+ *        Only to be called from the consumer thread
  * 
- * @param preserveIds  true to keep the ids
+ * @param changes  receives the changes
+ * @param maxCount  maximum number of changes to take
+ * @return size_t number
  */
 template <class T>
-void spObjectStore<T>::recreate(bool preserveIds)
+size_t spObjectChangeQueue<T>::popAll(std::vector<sposChange<T>> &changes, size_t maxCount)
 {
-  size_t count = _ids.size();
-  if (count > 0)
+  size_t count = 0;
+  sposChange<T> change;
+  while ((count < maxCount) && pop(change))
   {
-    std::vector<std::string> old_ids(_ids);
-    if (preserveIds)
-    {
-      for (size_t i = 0; i < count; i++)
-      {
-        old_ids.push_back(_ids[i]);
-      }
-    }
-    std::vector<T> old_objects(_objects);
-    reset();
-    setCapacity(count + _capaInc);
-    for (size_t i = 0; i < count; i++)
-    {
-      if (preserveIds)
-      {
-        setObjWithId(old_ids[i], old_objects[i]);
-      }
-      else
-      {
-        setObjWithId(createId(old_objects[i]), old_objects[i]); 
-      }
-    }
+    changes.push_back(std::move(change));
+    count++;
   }
+  return count;
+}
+
+/**
+ * @brief Returns the number of changes the queue can hold
+ * 
+ * @return size_t number
+ */
+template <class T>
+size_t spObjectChangeQueue<T>::getCapacity()
+{
+  return _slots.size() - 1;
 }
 
 #endif // SPOBJECTSTORE_H_
\ No newline at end of file